@@ -0,0 +1,604 @@
+/*
+ *  Linked List Cache
+ *
+ */
+
+/*
+ *  Linked List Cache Implementation.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *  Cache is two ordinary lists with key hash index (open addressing,
+ *  see LHashIndexEnable), thus nodes are linked and found by LList and
+ *  this library only decides, in which list and position node belongs.
+ *  In LRU mode only the recent list is used.
+ *
+ *  Nodes are never deallocated while cache is full: evicted node is
+ *  detached from the end of list (which removes its key from index),
+ *  cleared, given new key and attached as first (which adds the key).
+ *  As the amount of keys stays the same, the hash index does not grow
+ *  either, only the deleted slots are cleaned up by occasional rehash.
+ *
+ */
+
+/* ------------------------------------------------------------------------- */
+
+
+#ifdef LCACHE_UNITTEST
+
+static void * os_block_alloc_and_clear(unsigned size);
+static void   os_block_dealloc(void * ptr);
+
+#else /* LCACHE_UNITTEST */
+
+/* Embedded OS headers */
+#include "global.h"
+#include "type_def.h"
+#include "os.h"
+
+#endif /* LCACHE_UNITTEST */
+
+/* External libraries */
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include "mpool.h"
+#include "llist.h"
+
+/* Library header */
+#include "lcache.h"
+
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Allocates new cache object.
+ *
+ */
+lcache_t * LCacheInit( unsigned node_size, unsigned key_offset, unsigned key_size,
+                       unsigned capacity, lcache_e mode, NodeClear_f NodeEvict, void * memorypool )
+{
+  lcache_t * cache = (lcache_t*)os_block_alloc_and_clear(sizeof(lcache_t));
+
+  assert(capacity > 0 && key_size > 0);
+  assert(key_offset + key_size <= node_size);
+
+  cache->mode       = mode;
+  cache->capacity   = capacity;
+  cache->key_offset = key_offset;
+  cache->key_size   = key_size;
+  cache->NodeEvict  = NodeEvict;
+
+  cache->probation_max = capacity / 4;
+
+  if (cache->probation_max == 0)
+    {
+      cache->probation_max = 1;
+    }
+
+  if (!memorypool)
+    {
+      memorypool = MPoolInit(node_size, MPOOL_WAIT, MPOOL_ZERO_MEMSET);
+      (void)MPoolReserveSpace(memorypool, capacity, MPOOL_RESERVE_PERMANENTLY);
+      cache->own_pool = LLIST_YES;
+    }
+
+  cache->memorypool = memorypool;
+
+  LSetup(cache->recent, node_size, NodeEvict);
+  cache->recent.memorypool = memorypool;
+  (void)LHashIndexEnable(&cache->recent, key_offset, key_size, NULL, NULL);
+
+  LSetup(cache->probation, node_size, NodeEvict);
+  cache->probation.memorypool = memorypool;
+  (void)LHashIndexEnable(&cache->probation, key_offset, key_size, NULL, NULL);
+
+  return cache;
+}
+
+
+/*
+ *  Removes all nodes, but the cache object itself remains valid.
+ *
+ */
+void LCacheRemoveAll( lcache_t * cache )
+{
+  LRemoveAll(&cache->recent);
+  LRemoveAll(&cache->probation);
+}
+
+
+/*
+ *  Disposes the cache by removing the nodes and finally
+ *  the cache object itself (and its own memory pool).
+ */
+void LCacheDispose( lcache_t ** cache )
+{
+  if (*cache)
+    {
+      LCacheRemoveAll(*cache);
+
+      LHashIndexDisable(&(*cache)->recent);
+      LHashIndexDisable(&(*cache)->probation);
+
+      if ((*cache)->own_pool)
+        {
+          MPoolDispose(&(*cache)->memorypool);
+        }
+
+      os_block_dealloc(*cache);
+      *cache = NULL;
+    }
+}
+
+
+/*
+ *  Find node by key and mark it as the most recently used.
+ *
+ */
+static lnode_t * LCacheFind( lcache_t * cache, const void * key )
+{
+  lnode_t * node = LLookup(&cache->recent, key);
+
+  if (node)
+    {
+      LMoveFirst(&cache->recent, node);
+    }
+  else if (cache->mode == LCACHE_2Q)
+    {
+      node = LLookup(&cache->probation, key);
+
+      if (node)
+        {
+          /* used again, promote from probation */
+          LDetach(&cache->probation, node);
+          LAttachFirst(&cache->recent, node);
+          cache->stat.promotions++;
+        }
+    }
+
+  return node;
+}
+
+
+/*
+ *  Find node by key (hit or miss is counted).
+ *
+ */
+lnode_t * LCacheLookup( lcache_t * cache, const void * key )
+{
+  lnode_t * node = LCacheFind(cache, key);
+
+  if (node)
+    {
+      cache->stat.hits++;
+    }
+  else
+    {
+      cache->stat.misses++;
+    }
+
+  return node;
+}
+
+
+/*
+ *  Detach the least recently used node for eviction.
+ *
+ */
+static lnode_t * LCacheEvict( lcache_t * cache )
+{
+  lnode_t * node;
+
+  if (cache->mode == LCACHE_2Q &&
+      (LCount(&cache->probation) >= cache->probation_max || !LCount(&cache->recent)))
+    {
+      node = LDetachLast(&cache->probation);
+    }
+  else
+    {
+      node = LDetachLast(&cache->recent);
+    }
+
+  cache->stat.evictions++;
+
+  if (cache->NodeEvict)
+    {
+      /* NULL returned if node was deallocated by callback */
+      node = cache->NodeEvict(node);
+    }
+
+  return node;
+}
+
+
+/*
+ *  Insert new key as the most recently used node.
+ *
+ */
+lnode_t * LCacheInsert( lcache_t * cache, const void * key )
+{
+  lnode_t * node = LCacheFind(cache, key);
+
+  if (node)
+    {
+      return node;
+    }
+
+  if (LCacheCount(cache) >= cache->capacity)
+    {
+      /* evicted node is reused as such */
+      node = LCacheEvict(cache);
+    }
+
+  if (!node)
+    {
+      node = (lnode_t*)MPoolAlloc(cache->memorypool);
+    }
+
+  (void)memset(node, 0, cache->recent.node_size);
+  (void)memcpy((char*)node + cache->key_offset, key, cache->key_size);
+
+  /* attaching adds the key into hash index */
+  if (cache->mode == LCACHE_2Q)
+    {
+      LAttachFirst(&cache->probation, node);
+    }
+  else
+    {
+      LAttachFirst(&cache->recent, node);
+    }
+
+  cache->stat.inserts++;
+
+  return node;
+}
+
+
+/*
+ *  Remove node by key.
+ *
+ */
+lbool_e LCacheRemove( lcache_t * cache, const void * key )
+{
+  llist_t * list = &cache->recent;
+  lnode_t * node = LLookup(list, key);
+
+  if (!node)
+    {
+      list = &cache->probation;
+      node = LLookup(list, key);
+    }
+
+  if (!node)
+    {
+      return LLIST_NO;
+    }
+
+  LDetach(list, node);
+  LDealloc(node, cache->NodeEvict, cache->memorypool);
+
+  return LLIST_YES;
+}
+
+
+/*
+ *  Get cache statistics.
+ *
+ */
+lcache_stat_t LCacheGetStatistics( lcache_t * cache )
+{
+  return cache->stat;
+}
+
+
+/*
+ *  Reset cache statistics, e.g. after warm up.
+ *
+ */
+void LCacheResetStatistics( lcache_t * cache )
+{
+  (void)memset(&cache->stat, 0, sizeof(lcache_stat_t));
+}
+
+
+/* --------------------------------------------------------------- */
+
+#ifdef LCACHE_UNITTEST
+
+/*
+ *  gcc -DLCACHE_UNITTEST -DLLIST_OS_STUBS -o lcache.exe lcache.c llist.c mpool.c
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static void * os_block_alloc_and_clear(unsigned size)
+{
+  return memset(malloc(size), 0, size);
+}
+
+static void os_block_dealloc(void* ptr)
+{
+  free(ptr);
+}
+
+
+/*
+ *  Test structure
+ *
+ */
+typedef struct
+{
+  LLIST_NODE
+  unsigned key;
+  unsigned value;
+} test_entry_t;
+
+static unsigned unittest_evicted;
+
+static lnode_t * unittest_evict( lnode_t * node )
+{
+  unittest_evicted++;
+  return node;
+}
+
+static lcache_t * unittest_cache( unsigned capacity, lcache_e mode )
+{
+  return LCacheInit(sizeof(test_entry_t), offsetof(test_entry_t, key), sizeof(unsigned),
+                    capacity, mode, unittest_evict, NULL);
+}
+
+static void unittest_insert( lcache_t * cache, unsigned key )
+{
+  test_entry_t * entry = (test_entry_t*)LCacheInsert(cache, &key);
+
+  assert(entry && entry->key == key && entry->value == 0);
+  entry->value = key * 10;
+}
+
+static unsigned unittest_key( llist_t * list, unsigned index )
+{
+  return ((test_entry_t*)LGetNode(list, index))->key;
+}
+
+
+/* ------ Testset 1 - LRU order ------ */
+static void unittest_testset1( void )
+{
+  lcache_t *    cache = unittest_cache(3, LCACHE_LRU);
+  lcache_stat_t stat;
+  unsigned      key;
+
+  printf("\n- Testset 1 -\n");
+
+  unittest_evicted = 0;
+
+  unittest_insert(cache, 1);
+  unittest_insert(cache, 2);
+  unittest_insert(cache, 3);
+  assert(LCacheCount(cache) == 3);
+
+  key = 1;
+  assert(((test_entry_t*)LCacheLookup(cache, &key))->value == 10);
+  assert(unittest_key(&cache->recent, 0) == 1);
+
+  /* 2 is the least recently used */
+  unittest_insert(cache, 4);
+  assert(LCacheCount(cache) == 3);
+  assert(unittest_evicted == 1);
+
+  key = 2;
+  assert(LCacheLookup(cache, &key) == NULL);
+  assert(unittest_key(&cache->recent, 0) == 4);
+  assert(unittest_key(&cache->recent, 1) == 1);
+  assert(unittest_key(&cache->recent, 2) == 3);
+
+  /* existing key is not inserted again */
+  key = 3;
+  assert(((test_entry_t*)LCacheInsert(cache, &key))->value == 30);
+  assert(unittest_key(&cache->recent, 0) == 3);
+
+  stat = LCacheGetStatistics(cache);
+  assert(stat.hits == 1 && stat.misses == 1 && stat.inserts == 4 && stat.evictions == 1);
+
+  assert(LCacheRemove(cache, &key) == LLIST_YES);
+  assert(LCacheRemove(cache, &key) == LLIST_NO);
+  assert(LCacheCount(cache) == 2 && unittest_evicted == 2);
+
+  LCacheDispose(&cache);
+  assert(cache == NULL && unittest_evicted == 4);
+
+  printf("OK\n");
+}
+
+
+/* ------ Testset 2 - 2Q order ------ */
+static void unittest_testset2( void )
+{
+  lcache_t *    cache = unittest_cache(4, LCACHE_2Q);
+  lcache_stat_t stat;
+  unsigned      key;
+
+  printf("\n- Testset 2 -\n");
+
+  unittest_evicted = 0;
+
+  unittest_insert(cache, 1);
+  unittest_insert(cache, 2);
+  assert(LCount(&cache->probation) == 2 && LCount(&cache->recent) == 0);
+
+  key = 1;
+  assert(LCacheLookup(cache, &key) != NULL);
+  key = 2;
+  assert(LCacheLookup(cache, &key) != NULL);
+  assert(LCount(&cache->probation) == 0);
+  assert(unittest_key(&cache->recent, 0) == 2);
+
+  /* scan of new keys evicts only from probation */
+  for(key = 100; key < 110; key++)
+    {
+      unittest_insert(cache, key);
+    }
+
+  assert(LCacheCount(cache) == 4);
+  assert(LCount(&cache->probation) == 2);
+  assert(unittest_key(&cache->probation, 0) == 109);
+  assert(unittest_key(&cache->probation, 1) == 108);
+
+  key = 1;
+  assert(((test_entry_t*)LCacheLookup(cache, &key))->value == 10);
+  key = 100;
+  assert(LCacheLookup(cache, &key) == NULL);
+
+  stat = LCacheGetStatistics(cache);
+  assert(stat.hits == 3 && stat.misses == 1 && stat.promotions == 2);
+  assert(stat.inserts == 12 && stat.evictions == 8 && unittest_evicted == 8);
+
+  LCacheResetStatistics(cache);
+  assert(LCacheGetStatistics(cache).hits == 0);
+
+  LCacheRemoveAll(cache);
+  assert(LCacheCount(cache) == 0 && unittest_evicted == 12);
+
+  key = 1;
+  assert(LCacheLookup(cache, &key) == NULL);
+
+  LCacheDispose(&cache);
+
+  printf("OK\n");
+}
+
+
+/* ------ Testset 3 - benchmark with zipfian traffic ------ */
+
+#define UNITTEST_KEYS      20000
+#define UNITTEST_CAPACITY  1000
+#define UNITTEST_REQUESTS  1000000
+
+static double   unittest_cdf[UNITTEST_KEYS];
+static unsigned unittest_random = 2463534242u;
+
+static unsigned unittest_zipf( void )
+{
+  double   value;
+  unsigned low = 0, high = UNITTEST_KEYS - 1;
+
+  /* xorshift32 */
+  unittest_random ^= unittest_random << 13;
+  unittest_random ^= unittest_random >> 17;
+  unittest_random ^= unittest_random << 5;
+
+  value = (double)unittest_random / 4294967296.0;
+
+  while(low < high)
+    {
+      unsigned middle = (low + high) / 2;
+
+      if (unittest_cdf[middle] < value)
+        {
+          low = middle + 1;
+        }
+      else
+        {
+          high = middle;
+        }
+    }
+
+  return low + 1;
+}
+
+static unsigned unittest_traffic( lcache_e mode, unsigned scan )
+{
+  lcache_t *     cache = unittest_cache(UNITTEST_CAPACITY, mode);
+  lcache_stat_t  stat;
+  test_entry_t * entry;
+  clock_t        time;
+  unsigned       once = UNITTEST_KEYS;
+  unsigned       i, key;
+
+  unittest_random = 2463534242u;
+  time = clock();
+
+  for(i = 0; i < UNITTEST_REQUESTS; i++)
+    {
+      /* every 'scan' request is a key used only once */
+      key = (scan && i % scan == 0 ? ++once : unittest_zipf());
+
+      entry = (test_entry_t*)LCacheLookup(cache, &key);
+
+      if (entry)
+        {
+          assert(entry->value == key * 10);
+        }
+      else
+        {
+          unittest_insert(cache, key);
+        }
+    }
+
+  time = clock() - time;
+  stat = LCacheGetStatistics(cache);
+
+  assert(stat.hits + stat.misses == UNITTEST_REQUESTS);
+  assert(stat.inserts == stat.misses);
+  assert(LCacheCount(cache) == UNITTEST_CAPACITY);
+
+  printf("%s %s: hit ratio %u.%u%%, %u ms\n", (mode == LCACHE_2Q ? "2Q " : "LRU"),
+         (scan ? "zipf+scan" : "zipf     "), stat.hits / (UNITTEST_REQUESTS / 100),
+         stat.hits / (UNITTEST_REQUESTS / 1000) % 10, (unsigned)(time * 1000 / CLOCKS_PER_SEC));
+
+  LCacheDispose(&cache);
+
+  return stat.hits;
+}
+
+static void unittest_testset3( void )
+{
+  double   sum = 0;
+  unsigned i, lru, twoq;
+
+  printf("\n- Testset 3 -\n");
+
+  /* zipf distribution with exponent 1 */
+  for(i = 0; i < UNITTEST_KEYS; i++)
+    {
+      sum += 1.0 / (i + 1);
+      unittest_cdf[i] = sum;
+    }
+
+  for(i = 0; i < UNITTEST_KEYS; i++)
+    {
+      unittest_cdf[i] /= sum;
+    }
+
+  lru  = unittest_traffic(LCACHE_LRU, 0);
+  twoq = unittest_traffic(LCACHE_2Q,  0);
+  assert(lru > UNITTEST_REQUESTS / 2 && twoq > UNITTEST_REQUESTS / 2);
+
+  /* 2Q keeps the frequently used keys over scan */
+  lru  = unittest_traffic(LCACHE_LRU, 3);
+  twoq = unittest_traffic(LCACHE_2Q,  3);
+  assert(twoq > lru);
+
+  printf("OK\n");
+}
+
+
+/*
+ *  Test harness for cache.
+ *
+ */
+int main(void)
+{
+  printf("\nunittest - lcache.c\n");
+
+  unittest_testset1();
+  unittest_testset2();
+  unittest_testset3();
+
+  printf("\nunittest - done.\n");
+  return 0;
+}
+
+#endif /* LCACHE_UNITTEST */
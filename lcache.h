@@ -0,0 +1,184 @@
+/*
+ *  Linked List Cache Header
+ *
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#ifndef LCACHE_H
+#define LCACHE_H
+
+
+#include "llist.h"
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  LRU and 2Q caches of linked list nodes.
+ *
+ *  Cache holds at most 'capacity' nodes with a fixed size key (member
+ *  of 'key_size' bytes at 'key_offset' of node). Nodes are kept in
+ *  llist_t in recency order and found by the key hash index of the
+ *  list (LHashIndexEnable), thus a hit is one hash probe and moving
+ *  the node to the front of list (LMoveFirst), and the least recently
+ *  used node to evict is always the last node of list.
+ *
+ *   LRU:  recent:    [hit/new]<->[node]<->....<->[node]  -> evicted
+ *
+ *   2Q:   probation: [new]<->[node]<->....<->[node]      -> evicted
+ *                       | second hit
+ *         recent:    [hit]<->[node]<->....<->[node]      -> evicted
+ *
+ *  With 2Q new keys enter into probation queue (FIFO), and only keys
+ *  hit again while there are promoted into recent (LRU) queue, thus a
+ *  scan of keys used only once can not flush the frequently used keys.
+ *  Probation queue may take a quarter of the capacity (no ghost queue).
+ *
+ *  Nodes are allocated from memory pool (mpool.h) reserved for full
+ *  capacity, and evicted node is reused for the new key as such.
+ *
+ *  (This library is not thread safe, as llist.h is not either)
+ *
+ */
+
+/* --------------------------------------------------------------- */
+/* 1. Structure and prototypes for cache usage                     */
+/* --------------------------------------------------------------- */
+
+
+typedef enum
+{
+  LCACHE_LRU = 0,
+  LCACHE_2Q  = 1
+
+} lcache_e;
+
+
+/*
+ *  Statistics of cache usage.
+ */
+typedef struct
+{
+  unsigned  hits;            /* Lookups which found the key       */
+  unsigned  misses;          /* Lookups which did not find key    */
+  unsigned  inserts;         /* New keys inserted                 */
+  unsigned  evictions;       /* Nodes evicted to make space       */
+  unsigned  promotions;      /* 2Q: nodes moved from probation    */
+
+} lcache_stat_t;
+
+
+/*
+ *  (lcache_t*) -  Cache type, only accessed by LCache* functions.
+ */
+typedef struct
+{
+  llist_t        recent;     /* LRU list, or 2Q queue of reused keys */
+  llist_t        probation;  /* 2Q queue of new keys                 */
+  lcache_e       mode;
+  unsigned       capacity;
+  unsigned       probation_max;
+  unsigned       key_offset;
+  unsigned       key_size;
+  NodeClear_f    NodeEvict;
+  lcache_stat_t  stat;
+
+  /*
+   *  Memory pool of nodes, which is created by LCacheInit
+   *  if not given (and then disposed by LCacheDispose).
+   */
+  void *         memorypool;
+  lbool_e        own_pool;
+
+} lcache_t;
+
+
+/* --------------------------------------------------------------- */
+/* 2. Functions for cache handling.                                */
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Initialize (and allocate) the cache object. Memory pool can be given
+ *  (block size must be the node size), or NULL to create cache own pool.
+ *  NodeEvict (optional) is called for each evicted or removed node to
+ *  release its resources, with same semantics as NodeClear_f in llist.h.
+ *  Disposing removes also all nodes left in cache.
+ */
+lcache_t * LCacheInit( unsigned node_size, unsigned key_offset, unsigned key_size,
+                       unsigned capacity, lcache_e mode, NodeClear_f NodeEvict, void * memorypool );
+void       LCacheDispose( lcache_t ** cache );
+
+
+/*
+ *  Find node by key (pointer to key value). Hit marks the node as most
+ *  recently used, and NULL is returned on miss. Both are counted.
+ */
+lnode_t *  LCacheLookup( lcache_t * cache, const void * key );
+
+
+/*
+ *  Insert new key, evicting the least recently used node if the cache is
+ *  full. Returned node is cleared and has only the key set, to be filled
+ *  by caller. If key is already in cache, its node is returned as such.
+ */
+lnode_t *  LCacheInsert( lcache_t * cache, const void * key );
+
+
+/*
+ *  Remove node by key (LLIST_NO returned if key was not in cache),
+ *  or remove all nodes. Statistics are not changed.
+ */
+lbool_e    LCacheRemove(    lcache_t * cache, const void * key );
+void       LCacheRemoveAll( lcache_t * cache );
+
+
+/*
+ *  Get cache information.
+ */
+#define    LCacheCount( cache )  (LCount(&(cache)->recent) + LCount(&(cache)->probation))
+
+lcache_stat_t LCacheGetStatistics(   lcache_t * cache );
+void          LCacheResetStatistics( lcache_t * cache );
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Example how to use cache.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^
+ *
+ *  typedef struct
+ *  {
+ *    LLIST_NODE
+ *    unsigned  id;
+ *    char      name[32];
+ *  } user_t;
+ *
+ *  lcache_t * users = LCacheInit(sizeof(user_t), offsetof(user_t, id), sizeof(unsigned),
+ *                                1000, LCACHE_2Q, NULL, NULL);
+ *
+ *  user_t * user = (user_t*)LCacheLookup(users, &id);
+ *
+ *  if (!user)
+ *    {
+ *      user = (user_t*)LCacheInsert(users, &id);
+ *      LoadUserName(id, user->name);
+ *    }
+ *
+ *  LCacheDispose(&users);
+ */
+
+
+/* --------------------------------------------------------------- */
+
+#endif /* LCACHE_H */
+
+#ifdef __cplusplus
+}
+#endif
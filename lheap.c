@@ -0,0 +1,546 @@
+/*
+ *  Linked List Heap
+ *
+ */
+
+/*
+ *  Linked List Heap Implementation.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *  Two trees are linked by making the greater root the first child of
+ *  the smaller root. Root has no siblings, and its prev is NULL.
+ *
+ *  Popping the root combines its children in two passes: first adjacent
+ *  pairs from left to right are linked (and chained in reverse order by
+ *  next link), then the pairs are linked from right to left into one tree.
+ *  Decreasing a key cuts the subtree of node and links it with root.
+ *
+ */
+
+/* ------------------------------------------------------------------------- */
+
+
+/* External libraries */
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include "llist.h"
+
+/* Library header */
+#include "lheap.h"
+
+/* --------------------------------------------------------------- */
+
+
+#define _LChild( node )   (((lheapnode_t*)(node))->child)
+
+
+/*
+ *  Setup the heap.
+ *
+ */
+void LHeapSetup( lheap_t * heap, NodeCmp_f NodeCmp )
+{
+  heap->root    = NULL;
+  heap->count   = 0;
+  heap->NodeCmp = NodeCmp;
+}
+
+
+/*
+ *  Link two trees (both not NULL), returns the new root.
+ *
+ */
+static lnode_t * LHeapLink( lheap_t * heap, lnode_t * tree1, lnode_t * tree2 )
+{
+  lnode_t * swap;
+
+  if (heap->NodeCmp(tree2, tree1) < 0)
+    {
+      swap  = tree1;
+      tree1 = tree2;
+      tree2 = swap;
+    }
+
+  tree2->next = _LChild(tree1);
+  tree2->prev = tree1;
+
+  if (tree2->next)
+    {
+      tree2->next->prev = tree2;
+    }
+
+  _LChild(tree1) = tree2;
+
+  return tree1;
+}
+
+
+/*
+ *  Combine children (siblings from first) into one tree in two passes.
+ *
+ */
+static lnode_t * LHeapCombine( lheap_t * heap, lnode_t * first )
+{
+  lnode_t * pairs = NULL;
+  lnode_t * tree;
+
+  while(first)
+    {
+      lnode_t * second = first->next;
+
+      tree  = first;
+      first = (second ? second->next : NULL);
+
+      tree->prev = NULL;
+
+      if (second)
+        {
+          second->next = NULL;
+          second->prev = NULL;
+          tree = LHeapLink(heap, tree, second);
+        }
+
+      tree->next = pairs;
+      pairs = tree;
+    }
+
+  tree = pairs;
+
+  if (tree)
+    {
+      pairs = tree->next;
+      tree->next = NULL;
+
+      while(pairs)
+        {
+          lnode_t * pair = pairs;
+
+          pairs = pair->next;
+          pair->next = NULL;
+          tree = LHeapLink(heap, pair, tree);
+        }
+    }
+
+  return tree;
+}
+
+
+/*
+ *  Cut the subtree of node (not root) from its parent or sibling.
+ *
+ */
+static void LHeapCut( lnode_t * node )
+{
+  if (_LChild(node->prev) == node)
+    {
+      _LChild(node->prev) = node->next;
+    }
+  else
+    {
+      node->prev->next = node->next;
+    }
+
+  if (node->next)
+    {
+      node->next->prev = node->prev;
+    }
+
+  node->next = NULL;
+  node->prev = NULL;
+}
+
+
+/*
+ *  Insert node.
+ *
+ */
+void LHeapInsert( lheap_t * heap, lnode_t * node )
+{
+  node->next     = NULL;
+  node->prev     = NULL;
+  _LChild(node)  = NULL;
+
+  heap->root = (heap->root ? LHeapLink(heap, heap->root, node) : node);
+  heap->count++;
+}
+
+
+/*
+ *  Pop the smallest node.
+ *
+ */
+lnode_t * LHeapPop( lheap_t * heap )
+{
+  lnode_t * node = heap->root;
+
+  if (node)
+    {
+      heap->root = LHeapCombine(heap, _LChild(node));
+      heap->count--;
+
+      _LChild(node) = NULL;
+    }
+
+  return node;
+}
+
+
+/*
+ *  Move node with decreased key towards root.
+ *
+ */
+void LHeapDecrease( lheap_t * heap, lnode_t * node )
+{
+  if (node != heap->root)
+    {
+      LHeapCut(node);
+      heap->root = LHeapLink(heap, heap->root, node);
+    }
+}
+
+
+/*
+ *  Remove node from heap.
+ *
+ */
+void LHeapRemove( lheap_t * heap, lnode_t * node )
+{
+  lnode_t * tree;
+
+  if (node == heap->root)
+    {
+      (void)LHeapPop(heap);
+    }
+  else
+    {
+      LHeapCut(node);
+      tree = LHeapCombine(heap, _LChild(node));
+      _LChild(node) = NULL;
+
+      if (tree)
+        {
+          heap->root = LHeapLink(heap, heap->root, tree);
+        }
+
+      heap->count--;
+    }
+}
+
+
+/*
+ *  Meld other heap into heap.
+ *
+ */
+void LHeapMeld( lheap_t * heap, lheap_t * other )
+{
+  if (other->root)
+    {
+      heap->root   = (heap->root ? LHeapLink(heap, heap->root, other->root) : other->root);
+      heap->count += other->count;
+
+      other->root  = NULL;
+      other->count = 0;
+    }
+}
+
+
+/*
+ *  Move list nodes into heap. Nodes are linked from last, and equal node
+ *  is linked as root, thus each node of sorted list becomes the parent
+ *  of the previous root (and equal nodes are popped in list order).
+ *
+ */
+void LHeapFromList( lheap_t * heap, llist_t * list )
+{
+  lnode_t * node = LLast(list);
+
+  heap->count += LCount(list);
+  (void)LDetachAll(list);
+
+  while(node)
+    {
+      lnode_t * prev = node->prev;
+
+      node->next    = NULL;
+      node->prev    = NULL;
+      _LChild(node) = NULL;
+
+      heap->root = (heap->root ? LHeapLink(heap, node, heap->root) : node);
+      node = prev;
+    }
+}
+
+
+/*
+ *  Pop heap nodes into list in sorted order.
+ *
+ */
+void LHeapToList( lheap_t * heap, llist_t * list )
+{
+  lnode_t * node;
+
+  while((node = LHeapPop(heap)) != NULL)
+    {
+      LAttachLast(list, node);
+    }
+}
+
+
+/* --------------------------------------------------------------- */
+
+#ifdef LHEAP_UNITTEST
+
+/*
+ *  gcc -DLHEAP_UNITTEST -DLLIST_OS_STUBS -o lheap.exe lheap.c llist.c mpool.c
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/*
+ *  Test structure
+ *
+ */
+typedef struct
+{
+  LHEAP_NODE
+  unsigned id;
+  unsigned value;
+} test_item_t;
+
+#define UNITTEST_ITEMS  20000
+
+static test_item_t unittest_items[UNITTEST_ITEMS];
+static unsigned    unittest_random = 2463534242u;
+
+static unsigned unittest_rand( void )
+{
+  /* xorshift32 */
+  unittest_random ^= unittest_random << 13;
+  unittest_random ^= unittest_random >> 17;
+  unittest_random ^= unittest_random << 5;
+
+  return unittest_random;
+}
+
+static signed int unittest_compare( const lnode_t * node1, const lnode_t * node2 )
+{
+  return (((test_item_t*)node1)->value < ((test_item_t*)node2)->value ? LNODECMP_SMALLER :
+          ((test_item_t*)node1)->value > ((test_item_t*)node2)->value ? LNODECMP_GREATER : LNODECMP_EQUAL);
+}
+
+static void unittest_fill( unsigned count, unsigned range )
+{
+  unsigned i;
+
+  (void)memset(unittest_items, 0, sizeof(unittest_items));
+
+  for(i = 0; i < count; i++)
+    {
+      unittest_items[i].id    = i;
+      unittest_items[i].value = unittest_rand() % range;
+    }
+}
+
+static unsigned unittest_drain( lheap_t * heap )
+{
+  test_item_t * item;
+  unsigned      count = 0;
+  unsigned      last  = 0;
+
+  while((item = (test_item_t*)LHeapPop(heap)) != NULL)
+    {
+      assert(item->value >= last);
+      assert(item->next == NULL && item->prev == NULL && item->child == NULL);
+      last = item->value;
+      count++;
+    }
+
+  assert(LHeapCount(heap) == 0);
+
+  return count;
+}
+
+
+/* ------ Testset 1 - insert, pop, decrease and remove ------ */
+static void unittest_testset1( void )
+{
+  lheap_t  heap;
+  unsigned i, removed = 0;
+
+  printf("\n- Testset 1 -\n");
+
+  LHeapSetup(&heap, unittest_compare);
+  assert(LHeapPop(&heap) == NULL);
+
+  unittest_fill(1000, 100000);
+
+  for(i = 0; i < 1000; i++)
+    {
+      LHeapInsert(&heap, (lnode_t*)&unittest_items[i]);
+    }
+
+  assert(LHeapCount(&heap) == 1000);
+
+  /* pop some to build deeper trees */
+  for(i = 0; i < 100; i++)
+    {
+      test_item_t * item = (test_item_t*)LHeapPop(&heap);
+
+      assert(item->value <= ((test_item_t*)LHeapMin(&heap))->value);
+      item->value = 200000;
+      LHeapInsert(&heap, (lnode_t*)item);
+    }
+
+  for(i = 0; i < 1000; i += 3)
+    {
+      unittest_items[i].value /= 2;
+      LHeapDecrease(&heap, (lnode_t*)&unittest_items[i]);
+    }
+
+  for(i = 0; i < 1000; i++)
+    {
+      assert(((test_item_t*)LHeapMin(&heap))->value <= unittest_items[i].value);
+    }
+
+  for(i = 1; i < 1000; i += 5)
+    {
+      LHeapRemove(&heap, (lnode_t*)&unittest_items[i]);
+      removed++;
+    }
+
+  LHeapRemove(&heap, LHeapMin(&heap));
+  removed++;
+
+  assert(LHeapCount(&heap) == 1000 - removed);
+  assert(unittest_drain(&heap) == 1000 - removed);
+
+  printf("OK\n");
+}
+
+
+/* ------ Testset 2 - meld and lists ------ */
+static void unittest_testset2( void )
+{
+  lheap_t     heap1, heap2;
+  llist_t     list;
+  lnode_t *   node;
+  test_item_t single;
+  unsigned    i;
+
+  printf("\n- Testset 2 -\n");
+
+  LHeapSetup(&heap1, unittest_compare);
+  LHeapSetup(&heap2, unittest_compare);
+  LSetup(list, sizeof(test_item_t), NULL);
+
+  unittest_fill(2000, 500);
+
+  for(i = 0; i < 2000; i++)
+    {
+      LHeapInsert((i & 1 ? &heap1 : &heap2), (lnode_t*)&unittest_items[i]);
+    }
+
+  LHeapMeld(&heap1, &heap2);
+  assert(LHeapCount(&heap1) == 2000 && LHeapCount(&heap2) == 0);
+
+  LHeapMeld(&heap2, &heap1);
+  assert(LHeapCount(&heap1) == 0 && LHeapCount(&heap2) == 2000);
+
+  LHeapToList(&heap2, &list);
+  assert(LCount(&list) == 2000);
+  assert(LVerify(&list, unittest_compare) == LLIST_YES);
+
+  /* sorted list becomes a path of single children */
+  LHeapFromList(&heap1, &list);
+  assert(LCount(&list) == 0 && LHeapCount(&heap1) == 2000);
+
+  for(node = LHeapMin(&heap1); node; node = ((lheapnode_t*)node)->child)
+    {
+      assert(node->next == NULL);
+    }
+
+  LHeapToList(&heap1, &list);
+  assert(LCount(&list) == 2000);
+  assert(LVerify(&list, unittest_compare) == LLIST_YES);
+
+  /* unsorted list */
+  LReverse(&list);
+  LHeapFromList(&heap1, &list);
+  assert(unittest_drain(&heap1) == 2000);
+
+  single.value = 7;
+  LHeapInsert(&heap1, (lnode_t*)&single);
+  LHeapDecrease(&heap1, (lnode_t*)&single);
+  LHeapRemove(&heap1, (lnode_t*)&single);
+  assert(LHeapCount(&heap1) == 0 && LHeapMin(&heap1) == NULL);
+
+  printf("OK\n");
+}
+
+
+/* ------ Testset 3 - benchmark against sorted list ------ */
+static void unittest_testset3( void )
+{
+  lheap_t  heap;
+  llist_t  list;
+  clock_t  time;
+  unsigned i;
+
+  printf("\n- Testset 3 -\n");
+
+  LHeapSetup(&heap, unittest_compare);
+  LSetup(list, sizeof(test_item_t), NULL);
+
+  unittest_random = 2463534242u;
+  unittest_fill(UNITTEST_ITEMS, 1000000);
+  time = clock();
+
+  for(i = 0; i < UNITTEST_ITEMS; i++)
+    {
+      LAttachSorted(&list, (lnode_t*)&unittest_items[i], unittest_compare, LLOOP_BACKWARD);
+    }
+
+  while(LDetachFirst(&list));
+
+  printf("Sorted list: %u items queued and popped in %u ms\n", UNITTEST_ITEMS,
+         (unsigned)((clock() - time) * 1000 / CLOCKS_PER_SEC));
+
+  unittest_random = 2463534242u;
+  unittest_fill(UNITTEST_ITEMS, 1000000);
+  time = clock();
+
+  for(i = 0; i < UNITTEST_ITEMS; i++)
+    {
+      LHeapInsert(&heap, (lnode_t*)&unittest_items[i]);
+    }
+
+  assert(unittest_drain(&heap) == UNITTEST_ITEMS);
+
+  printf("Heap:        %u items queued and popped in %u ms\n", UNITTEST_ITEMS,
+         (unsigned)((clock() - time) * 1000 / CLOCKS_PER_SEC));
+
+  printf("OK\n");
+}
+
+
+/*
+ *  Test harness for heap.
+ *
+ */
+int main(void)
+{
+  printf("\nunittest - lheap.c\n");
+
+  unittest_testset1();
+  unittest_testset2();
+  unittest_testset3();
+
+  printf("\nunittest - done.\n");
+  return 0;
+}
+
+#endif /* LHEAP_UNITTEST */
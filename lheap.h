@@ -0,0 +1,158 @@
+/*
+ *  Linked List Heap Header
+ *
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#ifndef LHEAP_H
+#define LHEAP_H
+
+
+#include "llist.h"
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Pairing heap (priority queue) of linked list nodes.
+ *
+ *  Heap nodes begin with LHEAP_NODE fields, which are LLIST_NODE fields
+ *  followed by the first child link, thus the same node can be queued in
+ *  heap or linked into any list (one at a time). In heap the next and prev
+ *  links join the children of a node, so that prev of the first child is
+ *  the parent:
+ *
+ *   root
+ *    |child
+ *   [node]<->[node]<->[node]     (next/prev)
+ *    |child        |child
+ *   [node]        [node]<->[node]
+ *
+ *  Insert, meld and decrease-key link two trees in O(1), and popping the
+ *  minimum (root) pairs its children in two passes in O(log n) amortized.
+ *  Nodes are ordered by NodeCmp_f as with lists (smallest first).
+ *
+ *  Heap does not allocate nodes, it only links them.
+ *
+ *  (This library is not thread safe, as llist.h is not either)
+ *
+ */
+
+/* --------------------------------------------------------------- */
+/* 1. Structure and prototypes for heap usage                      */
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Heap node fields in the beginning of the structure.
+ */
+#define LHEAP_NODE          \
+  LLIST_NODE                \
+  lnode_t * child;
+
+typedef struct
+{
+  LHEAP_NODE
+} lheapnode_t;
+
+
+/*
+ *  (lheap_t) -  Heap, only accessed by LHeap* functions
+ *  (can be static object).
+ */
+typedef struct
+{
+  lnode_t *   root;          /* Smallest node                 */
+  unsigned    count;
+  NodeCmp_f   NodeCmp;
+
+} lheap_t;
+
+
+/* --------------------------------------------------------------- */
+/* 2. Functions for heap handling.                                 */
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Setup the heap object with compare function (no allocations).
+ */
+void       LHeapSetup( lheap_t * heap, NodeCmp_f NodeCmp );
+
+
+/*
+ *  Get heap information and the smallest node (NULL if empty).
+ */
+#define    LHeapCount( heap )   ((unsigned)(heap)->count)
+#define    LHeapMin( heap )     ((heap)->root)
+
+
+/*
+ *  Insert node, or pop the smallest node (NULL returned if heap is empty).
+ *  Popped node is unlinked, thus it can be attached into list as such.
+ */
+void       LHeapInsert( lheap_t * heap, lnode_t * node );
+lnode_t *  LHeapPop(    lheap_t * heap );
+
+
+/*
+ *  Restore heap order after the key of node was decreased, or remove
+ *  any node from heap. Node must be in the heap.
+ */
+void       LHeapDecrease( lheap_t * heap, lnode_t * node );
+void       LHeapRemove(   lheap_t * heap, lnode_t * node );
+
+
+/*
+ *  Move all nodes of other heap (same compare function) into heap.
+ */
+void       LHeapMeld( lheap_t * heap, lheap_t * other );
+
+
+/*
+ *  Move all nodes of list into heap, or pop all nodes of heap as last into
+ *  list (thus list becomes sorted). Heap built from sorted list is a single
+ *  path, which pops each node again in O(1).
+ */
+void       LHeapFromList( lheap_t * heap, llist_t * list );
+void       LHeapToList(   lheap_t * heap, llist_t * list );
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Example how to use heap.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^
+ *
+ *  typedef struct
+ *  {
+ *    LHEAP_NODE
+ *    unsigned  distance;
+ *  } vertex_t;
+ *
+ *  static lheap_t queue;
+ *
+ *  LHeapSetup(&queue, CompareDistance);
+ *  LHeapInsert(&queue, (lnode_t*)source);
+ *
+ *  while((vertex = (vertex_t*)LHeapPop(&queue)) != NULL)
+ *    {
+ *      ...
+ *      neighbour->distance = vertex->distance + weight;
+ *      LHeapDecrease(&queue, (lnode_t*)neighbour);
+ *    }
+ */
+
+
+/* --------------------------------------------------------------- */
+
+#endif /* LHEAP_H */
+
+#ifdef __cplusplus
+}
+#endif
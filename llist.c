@@ -36,7 +36,11 @@
 /* ------------------------------------------------------------------------- */
 
 
-#if defined LLIST_UNITTEST || defined MPOOL_UNITTEST
+/*
+ *  Unit test builds of llist.c, mpool.c and of the modules on top of them
+ *  (built with LLIST_OS_STUBS) use malloc based stubs instead of OS blocks.
+ */
+#if defined LLIST_UNITTEST || defined MPOOL_UNITTEST || defined LLIST_OS_STUBS
 
 static void * os_block_alloc(unsigned size);
 static void * os_block_alloc_and_clear(unsigned size);
@@ -58,6 +62,13 @@ static void   os_block_dealloc(void * ptr);
 #include <assert.h>
 #include "mpool.h"
 
+/* Vector compares for column scanning */
+#if !defined LCOLUMN_SCALAR && defined __AVX2__
+#include <immintrin.h>
+#elif !defined LCOLUMN_SCALAR && defined __SSE2__
+#include <emmintrin.h>
+#endif
+
 /* Library header */
 #include "llist.h"
 
@@ -82,16 +93,469 @@ static void   os_block_dealloc(void * ptr);
  */
 #define  LInitFor( type, node, list ) \
     type node = (type)LFirst(list); \
-    for( ;(node);(node) = (type)LNext(node) )
+    for( ;(node) && (LPrefetch(LNext(node)), 1);(node) = (type)LNext(node) )
 
 #define  LInitBack( type, node, list ) \
     type node = (type)LLast(list); \
-    for( ;(node);(node) = (type)LPrev(node) )
+    for( ;(node) && (LPrefetch(LPrev(node)), 1);(node) = (type)LPrev(node) )
+
+/*
+ *  Prefetch pointer kept LLIST_PREFETCH_DISTANCE nodes ahead of the
+ *  current node. The chain itself can be followed only one node at
+ *  a time, thus this pays off only in loops calling back per node
+ *  (filters, compares), where the fetch is overlapped with the call.
+ *  Loops only relinking or copying nodes do not use it.
+ */
+#if LLIST_PREFETCH_DISTANCE > 0
+#define _LAheadInit( ahead, node, direction ) \
+    { unsigned _step = LLIST_PREFETCH_DISTANCE; ahead = (node); \
+      while(ahead && _step--) { ahead = LLoopNext(ahead, direction); LPrefetch(ahead); } }
+
+#define _LAheadStep( ahead, direction ) \
+    { if (ahead) { ahead = LLoopNext(ahead, direction); LPrefetch(ahead); } }
+#else
+#define _LAheadInit( ahead, node, direction )  { ahead = NULL; }
+#define _LAheadStep( ahead, direction )        { (void)(ahead); }
+#endif
 
 #define _LAllocate( list ) \
     ( (list)->memorypool ? (lnode_t*)MPoolAlloc((list)->memorypool) : \
     (lnode_t*)os_block_alloc_and_clear((list)->node_size) )
 
+/*
+ *  Spread the bits of user hash value, since callbacks often
+ *  return plain member values, which would cluster the slots.
+ */
+#define _LHashIndex( table, hash ) \
+    ((((hash) ^ ((hash) >> 16)) * 0x45D9F3Bu) & (table)->mask)
+
+
+/*
+ *  Sorted list index.
+ *  ^^^^^^^^^^^^^^^^^
+ *  Skip list with one entry per list node, where entries are in the same
+ *  order as nodes. Each entry has random number of levels (1/2 chance to
+ *  grow), which gives O(log n) search for insertion point and equal nodes.
+ *
+ *  head:   [3]-------------------------->[ ]
+ *          [2]---------->[ ]------------>[ ]
+ *          [1]---->[ ]-->[ ]------>[ ]-->[ ]
+ *          [0]-->[ ]-->[ ]-->[ ]-->[ ]-->[ ]-->[ ]
+ *                 1     2     2     5     7     9   <- list nodes
+ */
+#define LSKIP_MAX_LEVEL  24
+
+typedef struct lskipnode_t lskipnode_t;
+
+struct lskipnode_t
+{
+  lnode_t *     node;
+  unsigned      levels;
+  lskipnode_t * next[1];   /* [levels] */
+};
+
+typedef struct
+{
+  NodeCmp_f     NodeCmp;
+  unsigned      level;
+  unsigned      random;
+  lskipnode_t * head[LSKIP_MAX_LEVEL];
+} lskiplist_t;
+
+static void LSkipRemove( lskiplist_t * index, const lnode_t * node );
+static void LSkipClear(  lskiplist_t * index );
+
+
+/*
+ *  Key hash index.
+ *  ^^^^^^^^^^^^^^
+ *  Open addressing hash table of node pointers, which key is either member
+ *  value at fixed offset (compared as bytes) or given by hash and compare
+ *  functions. Removed nodes leave deleted markers, which are cleaned up
+ *  when the table is rebuilt during growth.
+ */
+typedef struct
+{
+  lnode_t * node;
+  unsigned  hash;
+} lkeyslot_t;
+
+typedef struct
+{
+  unsigned     offset;
+  unsigned     size;
+  NodeHash_f   NodeHash;
+  NodeCmp_f    NodeCmp;
+  lkeyslot_t * slots;
+  unsigned     mask;
+  unsigned     count;
+  unsigned     deleted;
+} lkeyindex_t;
+
+static lnode_t lkey_deleted;
+
+#define LKEY_DELETED  (&lkey_deleted)
+
+#define _LKeyOf( index, node ) \
+    ((index)->NodeHash ? (const void*)(node) : (const void*)((const char*)(node) + (index)->offset))
+
+static void LKeyInsert( lkeyindex_t * index, lnode_t * node );
+static void LKeyRemove( lkeyindex_t * index, const lnode_t * node );
+static void LKeyClear(  lkeyindex_t * index );
+
+
+/*
+ *  Hooks to keep the optional indices in sync with list changes
+ *  (and to change the list version, which tells columns to rebuild).
+ *  Removals keep the known order of list, other changes forget it.
+ */
+#define _LIndexBreak( list ) \
+    { (list)->version++; \
+      (list)->sortedby = NULL; \
+      if ((list)->sortindex) LSortIndexDisable(list); }
+
+#define _LIndexAdd( list, node ) \
+    { (list)->version++; \
+      if ((list)->hashindex) LKeyInsertChain((lkeyindex_t*)(list)->hashindex, node); }
+
+#define _LIndexRemove( list, node ) \
+    { (list)->version++; \
+      if ((list)->sortindex) LSkipRemove((lskiplist_t*)(list)->sortindex, node); \
+      if ((list)->hashindex) LKeyRemove((lkeyindex_t*)(list)->hashindex, node); }
+
+#define _LIndexClear( list ) \
+    { (list)->version++; \
+      if ((list)->sortindex) LSkipClear((lskiplist_t*)(list)->sortindex); \
+      if ((list)->hashindex) LKeyClear((lkeyindex_t*)(list)->hashindex); }
+
+
+/*
+ *  Random amount of levels for a new entry.
+ *
+ */
+static unsigned LSkipLevels( lskiplist_t * index )
+{
+  unsigned random = index->random;
+  unsigned levels = 1;
+
+  /* xorshift32 */
+  random ^= random << 13;
+  random ^= random >> 17;
+  random ^= random << 5;
+  index->random = random;
+
+  while((random & 1) && levels < LSKIP_MAX_LEVEL)
+    {
+      random >>= 1;
+      levels++;
+    }
+
+  return levels;
+}
+
+
+/*
+ *  Allocate new entry for node.
+ *
+ */
+static lskipnode_t * LSkipAlloc( lnode_t * node, unsigned levels )
+{
+  lskipnode_t * entry = (lskipnode_t*)os_block_alloc(
+      offsetof(lskipnode_t, next) + levels * sizeof(lskipnode_t*));
+
+  entry->node   = node;
+  entry->levels = levels;
+
+  return entry;
+}
+
+
+/*
+ *  Find the first entry, which node is not smaller than given node
+ *  (or greater than given node if upper is set). Predecessor links
+ *  of all levels are stored into update for insertion or removal.
+ */
+static lskipnode_t * LSkipSearch( lskiplist_t * index, const lnode_t * node, lbool_e upper,
+                                  lskipnode_t ** update[] )
+{
+  lskipnode_t ** links = index->head;
+  unsigned       level = LSKIP_MAX_LEVEL;
+
+  while(level-- > 0)
+    {
+      if (level < index->level)
+        {
+          while(links[level])
+            {
+              signed int cmp = index->NodeCmp(links[level]->node, node);
+
+              if (cmp > LNODECMP_EQUAL || (cmp == LNODECMP_EQUAL && !upper))
+                {
+                  break;
+                }
+
+              links = links[level]->next;
+            }
+        }
+
+      update[level] = links;
+    }
+
+  return links[0];
+}
+
+
+/*
+ *  Insert entry for node after predecessors found by LSkipSearch.
+ *
+ */
+static void LSkipInsert( lskiplist_t * index, lskipnode_t ** update[], lnode_t * node )
+{
+  unsigned      levels = LSkipLevels(index);
+  lskipnode_t * entry  = LSkipAlloc(node, levels);
+  unsigned      level;
+
+  if (levels > index->level)
+    {
+      index->level = levels;
+    }
+
+  for(level = 0; level < levels; level++)
+    {
+      entry->next[level]   = update[level][level];
+      update[level][level] = entry;
+    }
+}
+
+
+/*
+ *  Remove entry of node. Search finds the first one of equal
+ *  nodes, thus the exact node is looked among those.
+ */
+static void LSkipRemove( lskiplist_t * index, const lnode_t * node )
+{
+  lskipnode_t ** update[LSKIP_MAX_LEVEL];
+  lskipnode_t *  entry = LSkipSearch(index, node, LLIST_NO, update);
+  unsigned       level;
+
+  while(entry && entry->node != node)
+    {
+      if (index->NodeCmp(entry->node, node) != LNODECMP_EQUAL)
+        {
+          /* not indexed */
+          return;
+        }
+
+      entry = entry->next[0];
+    }
+
+  if (entry)
+    {
+      for(level = 0; level < entry->levels; level++)
+        {
+          lskipnode_t ** links = update[level];
+
+          while(links[level] != entry)
+            {
+              links = links[level]->next;
+            }
+
+          links[level] = entry->next[level];
+        }
+
+      while(index->level > 0 && !index->head[index->level - 1])
+        {
+          index->level--;
+        }
+
+      os_block_dealloc(entry);
+    }
+}
+
+
+/*
+ *  Deallocate all entries, but keep the index.
+ *
+ */
+static void LSkipClear( lskiplist_t * index )
+{
+  lskipnode_t * entry = index->head[0];
+
+  while(entry)
+    {
+      lskipnode_t * remove = entry;
+      entry = entry->next[0];
+      os_block_dealloc(remove);
+    }
+
+  (void)memset(index->head, 0, sizeof(index->head));
+  index->level = 0;
+}
+
+
+/*
+ *  Hash value of key (FNV-1a for member bytes).
+ *
+ */
+static unsigned LKeyHash( lkeyindex_t * index, const void * key )
+{
+  if (index->NodeHash)
+    {
+      return index->NodeHash((const lnode_t*)key);
+    }
+  else
+    {
+      const unsigned char * byte = (const unsigned char*)key;
+      unsigned hash = 2166136261u;
+      unsigned i;
+
+      for(i = 0; i < index->size; i++)
+        {
+          hash = (hash ^ byte[i]) * 16777619u;
+        }
+
+      return hash;
+    }
+}
+
+
+/*
+ *  Check if node has given key.
+ *
+ */
+static lbool_e LKeyMatch( lkeyindex_t * index, const lnode_t * node, const void * key )
+{
+  if (index->NodeHash)
+    {
+      return (index->NodeCmp(node, (const lnode_t*)key) == LNODECMP_EQUAL ? LLIST_YES : LLIST_NO);
+    }
+
+  return (memcmp(_LKeyOf(index, node), key, index->size) == 0 ? LLIST_YES : LLIST_NO);
+}
+
+
+/*
+ *  Rebuild slot table with room for given amount of nodes (load factor below 50%).
+ *
+ */
+static void LKeyResize( lkeyindex_t * index, unsigned count )
+{
+  lkeyslot_t * slots = index->slots;
+  unsigned     size  = index->mask + 1;
+  unsigned     newsize = 16;
+  unsigned     i;
+
+  while(newsize < count * 2)
+    {
+      newsize <<= 1;
+    }
+
+  index->slots   = (lkeyslot_t*)os_block_alloc_and_clear(newsize * sizeof(lkeyslot_t));
+  index->mask    = newsize - 1;
+  index->deleted = 0;
+
+  if (slots)
+    {
+      for(i = 0; i < size; i++)
+        {
+          if (slots[i].node && slots[i].node != LKEY_DELETED)
+            {
+              unsigned slot = _LHashIndex(index, slots[i].hash);
+
+              while(index->slots[slot].node)
+                {
+                  slot = (slot + 1) & index->mask;
+                }
+
+              index->slots[slot] = slots[i];
+            }
+        }
+
+      os_block_dealloc(slots);
+    }
+}
+
+
+/*
+ *  Add node into key index (equal keys allowed).
+ *
+ */
+static void LKeyInsert( lkeyindex_t * index, lnode_t * node )
+{
+  unsigned hash = LKeyHash(index, _LKeyOf(index, node));
+  unsigned slot;
+
+  if ((index->count + index->deleted + 1) * 2 > index->mask + 1)
+    {
+      LKeyResize(index, (index->count + 1) * 2);
+    }
+
+  slot = _LHashIndex(index, hash);
+
+  while(index->slots[slot].node && index->slots[slot].node != LKEY_DELETED)
+    {
+      slot = (slot + 1) & index->mask;
+    }
+
+  if (index->slots[slot].node == LKEY_DELETED)
+    {
+      index->deleted--;
+    }
+
+  index->slots[slot].node = node;
+  index->slots[slot].hash = hash;
+  index->count++;
+}
+
+
+/*
+ *  Add all detached nodes linked to given node.
+ *
+ */
+static void LKeyInsertChain( lkeyindex_t * index, lnode_t * node )
+{
+  while(node)
+    {
+      LKeyInsert(index, node);
+      node = node->next;
+    }
+}
+
+
+/*
+ *  Remove node from key index (nothing done if not indexed).
+ *
+ */
+static void LKeyRemove( lkeyindex_t * index, const lnode_t * node )
+{
+  unsigned slot = _LHashIndex(index, LKeyHash(index, _LKeyOf(index, node)));
+
+  while(index->slots[slot].node)
+    {
+      if (index->slots[slot].node == node)
+        {
+          index->slots[slot].node = LKEY_DELETED;
+          index->count--;
+          index->deleted++;
+          return;
+        }
+
+      slot = (slot + 1) & index->mask;
+    }
+}
+
+
+/*
+ *  Remove all nodes, but keep the index.
+ *
+ */
+static void LKeyClear( lkeyindex_t * index )
+{
+  (void)memset(index->slots, 0, (index->mask + 1) * sizeof(lkeyslot_t));
+  index->count   = 0;
+  index->deleted = 0;
+}
+
 
 /*
  *  Allocates new linked list object from RAM.
@@ -102,6 +566,7 @@ llist_t * LInit( unsigned node_size, NodeClear_f NodeClear, void * memorypool )
   llist_t * list   = (llist_t*)os_block_alloc_and_clear(sizeof(llist_t));
   list->clear_func = NodeClear;
   list->node_size  = node_size;
+  list->memorypool = memorypool;
 
   if (memorypool)
     {
@@ -109,7 +574,7 @@ llist_t * LInit( unsigned node_size, NodeClear_f NodeClear, void * memorypool )
       /* Sanity check for node to fit into pool block */
       assert(stat.block_size >= node_size);
       /* Sanity check for nodes being zeroed during alloc */
-      assert(stat.memset_zero);
+      assert(stat.memset == MPOOL_ZERO_MEMSET);
     }
 
   return list;
@@ -123,7 +588,9 @@ llist_t * LInit( unsigned node_size, NodeClear_f NodeClear, void * memorypool )
 lnode_t * LCreateLast( llist_t * list )
 {
   lnode_t * node = _LAllocate(list);
-  
+
+  _LIndexBreak(list);
+
   if (list->last)
     {
       /* (last)->next & prev<-(node) */
@@ -151,6 +618,8 @@ lnode_t * LCreateFirst( llist_t * list )
 {
   lnode_t * node = _LAllocate(list);
 
+  _LIndexBreak(list);
+
   if (list->first)
     {
       /* (node)->next & prev<-(first) */
@@ -183,6 +652,7 @@ lnode_t * LCreateBefore( llist_t * list, lnode_t * before )
   else
     {
       lnode_t * node = _LAllocate(list);
+      _LIndexBreak(list);
       /* (other->prev)->next & prev<-(node)->next & prev<-(other) */
       before->prev->next = node;
       node->prev   = before->prev;
@@ -207,6 +677,7 @@ lnode_t * LCreateAfter( llist_t * list, lnode_t * after )
   else
     {
       lnode_t * node = _LAllocate(list);
+      _LIndexBreak(list);
       /* (other)->next & prev<-(node)->next & prev<-(other->next) */
       after->next->prev = node;
       node->next  = after->next;
@@ -219,39 +690,111 @@ lnode_t * LCreateAfter( llist_t * list, lnode_t * after )
 
 
 /*
- *  Internal detachment for moving.
- *
+ *  Create many nodes at once after given node (or as first nodes, if NULL).
+ *  Nodes are linked together as chain, which is then linked into list once.
  */
-static void DetachForMoving( llist_t * list, lnode_t * node )
+lnode_t * LCreateMany( llist_t * list, unsigned count, lnode_t * after )
 {
-  if (node->next)
-    {
-      node->next->prev = node->prev;
-    }
-  else
+  lnode_t * first = NULL;
+  lnode_t * last  = NULL;
+  unsigned  i;
+
+  if (!count)
     {
-      list->last = node->prev;
+      return NULL;
     }
 
-  if (node->prev)
+  if (list->memorypool)
     {
-      node->prev->next = node->next;
+      (void)MPoolReserveSpace(list->memorypool, count, MPOOL_RESERVE_FOR_ONE_USE);
     }
-  else
+
+  _LIndexBreak(list);
+
+  for(i = 0; i < count; i++)
     {
-      list->first = node->next;
-    }
-}
+      lnode_t * node = _LAllocate(list);
 
+      node->prev = last;
 
-/*
- *  Move node as a first in list.
- *
- */
+      if (last)
+        {
+          last->next = node;
+        }
+      else
+        {
+          first = node;
+        }
+
+      last = node;
+    }
+
+  /*
+   *  Link the chain into list.
+   */
+  last->next = (after ? after->next : list->first);
+
+  if (last->next)
+    {
+      last->next->prev = last;
+    }
+  else
+    {
+      list->last = last;
+    }
+
+  first->prev = after;
+
+  if (after)
+    {
+      after->next = first;
+    }
+  else
+    {
+      list->first = first;
+    }
+
+  list->count += count;
+
+  return first;
+}
+
+
+/*
+ *  Internal detachment for moving.
+ *
+ */
+static void DetachForMoving( llist_t * list, lnode_t * node )
+{
+  if (node->next)
+    {
+      node->next->prev = node->prev;
+    }
+  else
+    {
+      list->last = node->prev;
+    }
+
+  if (node->prev)
+    {
+      node->prev->next = node->next;
+    }
+  else
+    {
+      list->first = node->next;
+    }
+}
+
+
+/*
+ *  Move node as a first in list.
+ *
+ */
 void LMoveFirst( llist_t * list, lnode_t * node )
 {
   if (node && node != list->first)
     {
+      _LIndexBreak(list);
       DetachForMoving(list, node);
 
       node->prev = NULL;
@@ -270,6 +813,7 @@ void LMoveLast( llist_t * list, lnode_t * node )
 {
   if (node && node != list->last)
     {
+      _LIndexBreak(list);
       DetachForMoving(list, node);
 
       node->next = NULL;
@@ -288,6 +832,7 @@ void LMoveAfter(  llist_t * list, lnode_t * node, lnode_t * after )
 {
   if (node && after && node != after)
     {
+      _LIndexBreak(list);
       DetachForMoving(list, node);
 
       if (after->next)
@@ -315,6 +860,7 @@ void LMoveBefore( llist_t * list, lnode_t * node, lnode_t * before )
 {
   if (node && before && node != before)
     {
+      _LIndexBreak(list);
       DetachForMoving(list, node);
 
       if (before->prev)
@@ -364,23 +910,16 @@ void LRemove( llist_t * list, lnode_t * node )
     {
       LDetach( list, node );
 
-      if (list->clear_func)
+      if (!list->clear_func || list->clear_func(node))
         {
-          if (list->clear_func(node))
+          if (list->memorypool)
             {
-              if (list->memorypool)
-                {
-                  MPoolDealloc(list->memorypool, (void*)&node);
-                }
-              else
-                {
-                  os_block_dealloc(node);
-                }
+              MPoolDealloc(list->memorypool, (void*)&node);
+            }
+          else
+            {
+              os_block_dealloc(node);
             }
-        }
-      else
-        {
-          os_block_dealloc(node);
         }
     }
 }
@@ -392,6 +931,8 @@ void LRemove( llist_t * list, lnode_t * node )
  */
 void LRemoveAll( llist_t * list )
 {
+  _LIndexClear(list);
+
   LDealloc(list->first, list->clear_func, list->memorypool);
 
   list->first = NULL;
@@ -408,6 +949,8 @@ void LDispose( llist_t ** list )
 {
   if (*list)
     {
+      LSortIndexDisable(*list);
+      LHashIndexDisable(*list);
       LDealloc((*list)->first, (*list)->clear_func, (*list)->memorypool);
       os_block_dealloc(*list);
       *list = NULL;
@@ -527,6 +1070,11 @@ lnode_t * LDetachFirst( llist_t * list )
 {
   lnode_t * node = list->first;
 
+  if (node)
+    {
+      _LIndexRemove(list, node);
+    }
+
   if (list->count > 1)
     {
       list->count--;
@@ -553,6 +1101,11 @@ lnode_t * LDetachLast( llist_t * list )
 {
   lnode_t * node = list->last;
 
+  if (node)
+    {
+      _LIndexRemove(list, node);
+    }
+
   if (list->count > 1)
     {
       list->count--;
@@ -579,6 +1132,8 @@ lnode_t * LDetachAll( llist_t * list )
 {
   lnode_t * node = list->first;
 
+  _LIndexClear(list);
+
   list->first = NULL;
   list->last  = NULL;
   list->count = 0;
@@ -595,6 +1150,8 @@ void LDetach( llist_t * list, lnode_t * node )
 {
   if (node)
     {
+      _LIndexRemove(list, node);
+
       if (node->next)
         {
           node->next->prev = node->prev;
@@ -683,6 +1240,18 @@ void LDetachMany( llist_t * list, lnode_t * node, unsigned number, lloop_e direc
       loop->next = NULL;
       node->prev = NULL;
       list->count -= (number - count);
+      list->version++;
+
+      if (list->sortindex || list->hashindex)
+        {
+          /*
+           *  Remove index entries of detached nodes.
+           */
+          for(loop = node; loop; loop = loop->next)
+            {
+              _LIndexRemove(list, loop);
+            }
+        }
     }
 }
 
@@ -777,6 +1346,9 @@ void LAttachAfter( llist_t * list, lnode_t * node, lnode_t * after )
   lnode_t * loop = node;
   unsigned count = 1;
 
+  _LIndexBreak(list);
+  _LIndexAdd(list, node);
+
   /*
    *  Count detached nodes and get pointer to last one.
    */
@@ -827,6 +1399,9 @@ void LAttachBefore( llist_t * list, lnode_t * node, lnode_t * before )
   lnode_t * loop = node;
   unsigned count = 1;
 
+  _LIndexBreak(list);
+  _LIndexAdd(list, node);
+
   /*
    *  Count detached nodes and get pointer to last one.
    */
@@ -872,10 +1447,46 @@ void LAttachBefore( llist_t * list, lnode_t * node, lnode_t * before )
  *
  *
  */
-void LAttachSorted( llist_t * list, lnode_t * node, NodeCmp_f NodeCmp, lloop_e direction )
+static void LAttachSortedNode( llist_t * list, lnode_t * node, NodeCmp_f NodeCmp, lloop_e direction )
 {
   if (node && NodeCmp)
     {
+      if (list->sortindex)
+        {
+          lskiplist_t * index = (lskiplist_t*)list->sortindex;
+
+          if (index->NodeCmp == NodeCmp)
+            {
+              lskipnode_t ** update[LSKIP_MAX_LEVEL];
+              lskipnode_t *  entry = LSkipSearch(index, node,
+                  (direction == LLOOP_BACKWARD ? LLIST_YES : LLIST_NO), update);
+
+              /*
+               *  Suspend index during attach, since index
+               *  is updated here, instead of being disabled.
+               */
+              list->sortindex = NULL;
+
+              if (entry)
+                {
+                  LAttachBefore(list, node, entry->node);
+                }
+              else
+                {
+                  LAttachLast(list, node);
+                }
+
+              list->sortindex = index;
+              LSkipInsert(index, update, node);
+              return;
+            }
+
+          /*
+           *  Order by other compare function breaks the index.
+           */
+          LSortIndexDisable(list);
+        }
+
       if (direction == LLOOP_FORWARD)
         {
           LInitFor(lnode_t*, loop, list)
@@ -906,6 +1517,227 @@ void LAttachSorted( llist_t * list, lnode_t * node, NodeCmp_f NodeCmp, lloop_e d
 }
 
 
+/*
+ *  Attach node into its place in list sorted with given compare function.
+ *  Single node keeps the known order of the list.
+ */
+void LAttachSorted( llist_t * list, lnode_t * node, NodeCmp_f NodeCmp, lloop_e direction )
+{
+  NodeCmp_f sortedby = list->sortedby;
+
+  if (node && NodeCmp)
+    {
+      lbool_e single = (lbool_e)(node->next == NULL);
+
+      LAttachSortedNode(list, node, NodeCmp, direction);
+
+      if (single && sortedby == NodeCmp)
+        {
+          list->sortedby = sortedby;
+        }
+    }
+}
+
+
+/*
+ *  Build sorted list index for list already in order.
+ *
+ */
+lbool_e LSortIndexEnable( llist_t * list, NodeCmp_f NodeCmp )
+{
+  lskiplist_t *  index;
+  lskipnode_t ** tail[LSKIP_MAX_LEVEL];
+  unsigned       level;
+
+  LSortIndexDisable(list);
+
+  if (!NodeCmp || LVerify(list, NodeCmp) == LLIST_NO)
+    {
+      return LLIST_NO;
+    }
+
+  index = (lskiplist_t*)os_block_alloc_and_clear(sizeof(lskiplist_t));
+  index->NodeCmp = NodeCmp;
+  index->random  = 0x2545F491u;
+
+  for(level = 0; level < LSKIP_MAX_LEVEL; level++)
+    {
+      tail[level] = index->head;
+    }
+
+  /*
+   *  Append entries in list order, linking each level to its tail.
+   */
+  {
+    LInitFor(lnode_t*, node, list)
+      {
+        unsigned      levels = LSkipLevels(index);
+        lskipnode_t * entry  = LSkipAlloc(node, levels);
+
+        for(level = 0; level < levels; level++)
+          {
+            entry->next[level] = NULL;
+            tail[level][level] = entry;
+            tail[level] = entry->next;
+          }
+
+        if (levels > index->level)
+          {
+            index->level = levels;
+          }
+      }
+  }
+
+  list->sortindex = index;
+
+  return LLIST_YES;
+}
+
+
+/*
+ *  Deallocate sorted list index.
+ *
+ */
+void LSortIndexDisable( llist_t * list )
+{
+  if (list->sortindex)
+    {
+      LSkipClear((lskiplist_t*)list->sortindex);
+      os_block_dealloc(list->sortindex);
+      list->sortindex = NULL;
+    }
+}
+
+
+/*
+ *  Find the first node in list, which match with content of match_node.
+ *  Uses sorted list index if enabled with same compare function.
+ */
+lnode_t * LFindSorted( llist_t * list, NodeCmp_f NodeCmp, lnode_t * match_node )
+{
+  lskiplist_t * index = (lskiplist_t*)list->sortindex;
+
+  if (index && index->NodeCmp == NodeCmp && match_node)
+    {
+      lskipnode_t ** update[LSKIP_MAX_LEVEL];
+      lskipnode_t *  entry = LSkipSearch(index, match_node, LLIST_NO, update);
+
+      if (entry && NodeCmp(entry->node, match_node) == LNODECMP_EQUAL)
+        {
+          return entry->node;
+        }
+
+      /* no match */
+      return NULL;
+    }
+
+  return LFindPair(LFirst(list), NodeCmp, match_node, LLOOP_FORWARD);
+}
+
+
+/*
+ *  Build key hash index for list nodes.
+ *
+ */
+lbool_e LHashIndexEnable( llist_t * list, unsigned offset, unsigned size,
+                          NodeHash_f NodeHash, NodeCmp_f NodeCmp )
+{
+  lkeyindex_t * index;
+
+  LHashIndexDisable(list);
+
+  if (NodeHash ? !NodeCmp : !size)
+    {
+      return LLIST_NO;
+    }
+
+  index = (lkeyindex_t*)os_block_alloc_and_clear(sizeof(lkeyindex_t));
+  index->offset   = offset;
+  index->size     = size;
+  index->NodeHash = NodeHash;
+  index->NodeCmp  = NodeCmp;
+
+  LKeyResize(index, LCount(list));
+  LKeyInsertChain(index, LFirst(list));
+
+  list->hashindex = index;
+
+  return LLIST_YES;
+}
+
+
+/*
+ *  Deallocate key hash index.
+ *
+ */
+void LHashIndexDisable( llist_t * list )
+{
+  if (list->hashindex)
+    {
+      os_block_dealloc(((lkeyindex_t*)list->hashindex)->slots);
+      os_block_dealloc(list->hashindex);
+      list->hashindex = NULL;
+    }
+}
+
+
+/*
+ *  Add node into key hash index (node created by LCreate*,
+ *  or node key was modified after LHashIndexRemove).
+ */
+void LHashIndexAdd( llist_t * list, lnode_t * node )
+{
+  if (list->hashindex && node)
+    {
+      LKeyInsert((lkeyindex_t*)list->hashindex, node);
+    }
+}
+
+
+/*
+ *  Remove node from key hash index, e.g. before modifying its key.
+ *
+ */
+void LHashIndexRemove( llist_t * list, lnode_t * node )
+{
+  if (list->hashindex && node)
+    {
+      LKeyRemove((lkeyindex_t*)list->hashindex, node);
+    }
+}
+
+
+/*
+ *  Find node with given key by key hash index.
+ *
+ */
+lnode_t * LLookup( llist_t * list, const void * key )
+{
+  lkeyindex_t * index = (lkeyindex_t*)list->hashindex;
+
+  if (index && key)
+    {
+      unsigned hash = LKeyHash(index, key);
+      unsigned slot = _LHashIndex(index, hash);
+
+      while(index->slots[slot].node)
+        {
+          if (index->slots[slot].hash == hash &&
+              index->slots[slot].node != LKEY_DELETED &&
+              LKeyMatch(index, index->slots[slot].node, key))
+            {
+              return index->slots[slot].node;
+            }
+
+          slot = (slot + 1) & index->mask;
+        }
+    }
+
+  /* no match */
+  return NULL;
+}
+
+
 /*
  *  Swaps node placements inside the same list.
  *
@@ -914,6 +1746,8 @@ void LSwapInside( llist_t * list, lnode_t * node1, lnode_t * node2 )
 {
   if (node1 && node2)
     {
+      _LIndexBreak(list);
+
       /*
        *  Nodes in same list can be next each other
        *  or either can be first or last of the list.
@@ -1037,6 +1871,11 @@ void LSwapBetween( llist_t * list1, lnode_t * node1, llist_t * list2, lnode_t *
     {
       lnode_t * swap;
 
+      _LIndexBreak(list1);
+      _LIndexBreak(list2);
+      _LIndexRemove(list1, node1);
+      _LIndexRemove(list2, node2);
+
       if (node1->prev)
         {
           node1->prev->next = node2;
@@ -1080,6 +1919,16 @@ void LSwapBetween( llist_t * list1, lnode_t * node1, llist_t * list2, lnode_t *
       swap        = node1->prev;
       node1->prev = node2->prev;
       node2->prev = swap;
+
+      if (list1->hashindex)
+        {
+          LKeyInsert((lkeyindex_t*)list1->hashindex, node2);
+        }
+
+      if (list2->hashindex)
+        {
+          LKeyInsert((lkeyindex_t*)list2->hashindex, node1);
+        }
     }
 }
 
@@ -1092,6 +1941,8 @@ void LSwapAll( llist_t * list1, llist_t * list2 )
 {
   lnode_t * swap;
   unsigned count;
+  void * index;
+  NodeCmp_f sortedby;
 
   swap         = list1->first;
   list1->first = list2->first;
@@ -1104,6 +1955,21 @@ void LSwapAll( llist_t * list1, llist_t * list2 )
   count        = list1->count;
   list1->count = list2->count;
   list2->count = count;
+
+  index            = list1->sortindex;
+  list1->sortindex = list2->sortindex;
+  list2->sortindex = index;
+
+  index            = list1->hashindex;
+  list1->hashindex = list2->hashindex;
+  list2->hashindex = index;
+
+  sortedby         = list1->sortedby;
+  list1->sortedby  = list2->sortedby;
+  list2->sortedby  = sortedby;
+
+  list1->version++;
+  list2->version++;
 }
 
 
@@ -1115,11 +1981,24 @@ llist_t * LSplit( llist_t * list, lnode_t * node )
 {
   llist_t * newlist = LInit( list->node_size, list->clear_func, list->memorypool );
   int       index   = LGetIndex(list, node);
+  NodeCmp_f sortedby = list->sortedby;
+
+  _LIndexBreak(list);
 
   if (index > -1)
     {
       unsigned movecount  = list->count - index;
 
+      if (list->hashindex)
+        {
+          lnode_t * loop;
+
+          for(loop = node; loop; loop = loop->next)
+            {
+              LKeyRemove((lkeyindex_t*)list->hashindex, loop);
+            }
+        }
+
       newlist->count = movecount;
       newlist->first = node;
       newlist->last  = list->last;
@@ -1139,6 +2018,12 @@ llist_t * LSplit( llist_t * list, lnode_t * node )
       list->count -= movecount;
     }
 
+  /*
+   *  Both parts keep the order.
+   */
+  list->sortedby    = sortedby;
+  newlist->sortedby = sortedby;
+
   return newlist;
 }
 
@@ -1151,8 +2036,14 @@ void LJoin( llist_t * list, llist_t ** other )
 {
   if (other)
     {
+      _LIndexBreak(list);
+      LSortIndexDisable(*other);
+      LHashIndexDisable(*other);
+
       if ((*other)->first)
         {
+          _LIndexAdd(list, (*other)->first);
+
           if (list->last)
             {
               list->last->next = (*other)->first;
@@ -1174,13 +2065,127 @@ void LJoin( llist_t * list, llist_t ** other )
 
 
 /*
- *  Clones the list with given clone callback function or 
- *  based on known node size if callback function is NULL.
+ *  Move range of nodes (first...last) from list to other list after given node.
+ *  Range is relinked in constant time when its length is given (or when
+ *  both lists are same), otherwise the range is walked once to count it.
  */
-void LFilterClone( llist_t * list, llist_t ** other, NodeClone_f NodeClone, unsigned user_data )
+void LSpliceRange( llist_t * dst, lnode_t * after, llist_t * src,
+                   lnode_t * first, lnode_t * last, unsigned count )
 {
-  llist_t * clone = NULL;
-  lnode_t * loop  = list->first;
+  lnode_t * loop;
+
+  if (!first || !last)
+    {
+      return;
+    }
+
+#ifndef NDEBUG
+  /*
+   *  Within one list the destination must lie outside of the range,
+   *  otherwise the range would be linked after itself into a cycle.
+   */
+  if (dst == src && after)
+    {
+      for(loop = first; loop != last->next; loop = loop->next)
+        {
+          assert(loop != after);
+        }
+    }
+#endif
+
+  _LIndexBreak(dst);
+  _LIndexBreak(src);
+
+  if (dst != src)
+    {
+      if (!count || src->hashindex || dst->hashindex)
+        {
+          count = 1;
+
+          for(loop = first; loop != last; loop = loop->next)
+            {
+              if (src->hashindex)
+                {
+                  LKeyRemove((lkeyindex_t*)src->hashindex, loop);
+                }
+
+              count++;
+            }
+
+          if (src->hashindex)
+            {
+              LKeyRemove((lkeyindex_t*)src->hashindex, last);
+            }
+        }
+
+      src->count -= count;
+      dst->count += count;
+    }
+
+  /*
+   *  Unlink the range from source list.
+   */
+  if (first->prev)
+    {
+      first->prev->next = last->next;
+    }
+  else
+    {
+      src->first = last->next;
+    }
+
+  if (last->next)
+    {
+      last->next->prev = first->prev;
+    }
+  else
+    {
+      src->last = first->prev;
+    }
+
+  /*
+   *  Link the range into destination list.
+   */
+  last->next = (after ? after->next : dst->first);
+
+  if (last->next)
+    {
+      last->next->prev = last;
+    }
+  else
+    {
+      dst->last = last;
+    }
+
+  first->prev = after;
+
+  if (after)
+    {
+      after->next = first;
+    }
+  else
+    {
+      dst->first = first;
+    }
+
+  if (dst != src && dst->hashindex)
+    {
+      for(loop = first; loop != last->next; loop = loop->next)
+        {
+          LKeyInsert((lkeyindex_t*)dst->hashindex, loop);
+        }
+    }
+}
+
+
+/*
+ *  Clones the list with given clone callback function or 
+ *  based on known node size if callback function is NULL.
+ */
+void LFilterClone( llist_t * list, llist_t ** other, NodeClone_f NodeClone, unsigned user_data )
+{
+  llist_t * clone = NULL;
+  lnode_t * loop  = list->first;
   lnode_t * node  = NULL;
 
   /*
@@ -1225,22 +2230,65 @@ void LFilterClone( llist_t * list, llist_t ** other, NodeClone_f NodeClone, unsi
       else
         {
           /*
-           *  Auto-clones all the nodes.
+           *  Auto-clones all the nodes. Pool space is reserved at once,
+           *  and copies are linked into a chain, which is attached at once
+           *  (OS blocks are not cleared, as they are copied over).
            */
+          lnode_t * first = NULL;
+          lnode_t * last  = NULL;
+          unsigned  count = 0;
+
+          if (list->memorypool)
+            {
+              (void)MPoolReserveSpace(list->memorypool, list->count, MPOOL_RESERVE_FOR_ONE_USE);
+            }
+
           while(loop)
             {
-              lnode_t * node = _LAllocate(list);
+              node = (list->memorypool ? (lnode_t*)MPoolAlloc(list->memorypool) :
+                                         (lnode_t*)os_block_alloc(list->node_size));
 
-              if (node) 
+              if (node)
                 {
                   memcpy( node, loop, list->node_size );
-                  node->next = NULL;
-                  node->prev = NULL;
-                  LAttachLast(clone, node);
+                  node->prev = last;
+
+                  if (last)
+                    {
+                      last->next = node;
+                    }
+                  else
+                    {
+                      first = node;
+                    }
+
+                  last = node;
+                  count++;
                 }
 
               loop = loop->next;
             }
+
+          if (first)
+            {
+              last->next  = NULL;
+              first->prev = clone->last;
+
+              if (clone->last)
+                {
+                  clone->last->next = first;
+                }
+              else
+                {
+                  clone->first = first;
+                }
+
+              clone->last   = last;
+              clone->count += count;
+
+              _LIndexBreak(clone);
+              _LIndexAdd(clone, first);
+            }
         }
     }
 }
@@ -1287,154 +2335,503 @@ void LFilterMove( llist_t * list, llist_t ** other, NodeFilter_f NodeFilter, uns
 
 
 /*
- *  Count number of nodes match to filter.
+ *  Move nodes into bucket lists.
+ *
  */
-unsigned LFilterCount( llist_t * list, NodeFilter_f NodeFilter, unsigned user_data)
+unsigned LPartition( llist_t * list, NodeBucket_f NodeBucket, unsigned user_data,
+                                     llist_t * out[], unsigned n )
 {
-  lnode_t * node = LFirst(list);
-  unsigned count = LCount(list);
-  unsigned match = 0;
-  
-  if (NodeFilter)
+  lnode_t * loop  = LFirst(list);
+  lnode_t * node;
+  unsigned  bucket;
+  unsigned  moved = 0;
+
+  while(loop)
     {
-      /*
-       *  Use unlooping to minimize while loop.
-       */
-      while(count > 10)
-        {
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
-          count -= 10;
-        }
+      node = loop;
+      loop = LNext(loop);
 
-      while(node)
+      LPrefetch(loop);
+
+      bucket = NodeBucket(node, user_data);
+
+      if (bucket < n && out[bucket])
         {
-          match += NodeFilter(node, user_data);
-          node = LNext(node);
+          LDetach(list, node);
+          LAttachLast(out[bucket], node);
+          moved++;
         }
     }
-  else
-    {
-      match = count;
-    }
 
-  return match;
+  return moved;
 }
 
 
 /*
- *
+ *  Parallel filtering.
+ *  ^^^^^^^^^^^^^^^^^^
+ *  List is split into segments of equal size in one pass, and each segment
+ *  is filtered by a task run in worker pool. Tasks touch only the nodes of
+ *  their own segment: when nodes are detached, each task relinks its nodes
+ *  into chain of kept and chain of matching nodes, and the chains are then
+ *  linked together serially in segment order (thus filtering is stable).
+ */
+typedef struct
+{
+  lnode_t *    first;          /* First node of segment         */
+  unsigned     count;          /* Amount of nodes in segment    */
+  unsigned     match;          /* Amount of matching nodes      */
+  lnode_t *    keep_first;     /* Chain of nodes not detached   */
+  lnode_t *    keep_last;
+  lnode_t *    match_first;    /* Chain of detached nodes       */
+  lnode_t *    match_last;
+  NodeFilter_f NodeFilter;
+  unsigned     user_data_filter;
+  NodeFilter_f NodeOperate;
+  unsigned     user_data_operate;
+  lbool_e      detach;
+} lsegment_t;
+
+
+/*
+ *  Filter the nodes of one segment (run by worker pool).
  *
  */
-unsigned LFilterRemove( llist_t * list, NodeFilter_f NodeFilter, unsigned user_data )
+static void LSegmentTask( void * task )
 {
-  lnode_t * node = LFirst(list);
-  unsigned match = 0;
+  lsegment_t * segment = (lsegment_t*)task;
+  lnode_t * node  = segment->first;
+  unsigned  count = segment->count;
 
-  if (NodeFilter)
+  while(count--)
     {
-      while(node)
+      lnode_t * next = node->next;
+      lbool_e   match = LLIST_YES;
+
+      /*
+       *  Only the next node is prefetched, since links of the
+       *  following segment are modified by other tasks.
+       */
+      LPrefetch(next);
+
+      if (segment->NodeFilter)
         {
-          if (NodeFilter(node, user_data))
+          match = (segment->NodeFilter(node, segment->user_data_filter) ? LLIST_YES : LLIST_NO);
+        }
+
+      if (match)
+        {
+          segment->match++;
+
+          if (segment->NodeOperate)
             {
-              lnode_t * remove = node;
-              node = LNext(node);
-              LRemove(list, remove);
-              match++;
+              (void)segment->NodeOperate(node, segment->user_data_operate);
+            }
+        }
+
+      if (segment->detach)
+        {
+          lnode_t ** chain_first = (match ? &segment->match_first : &segment->keep_first);
+          lnode_t ** chain_last  = (match ? &segment->match_last  : &segment->keep_last);
+
+          node->prev = *chain_last;
+          node->next = NULL;
+
+          if (*chain_last)
+            {
+              (*chain_last)->next = node;
             }
           else
             {
-              node = LNext(node);
+              *chain_first = node;
             }
+
+          *chain_last = node;
         }
-    }
 
-  return match;
+      node = next;
+    }
 }
 
 
 /*
- *
- *
+ *  Split list into segments, run filter tasks in worker pool and
+ *  relink the kept nodes back to list. Returns chain of detached
+ *  nodes (if detach), and amount of matching nodes in *match.
  */
-unsigned LFilterOperate( llist_t * list, NodeFilter_f NodeFilter,  unsigned user_data_filter,
-                                         NodeFilter_f NodeOperate, unsigned user_data_operate)
+static lnode_t * LParallelFilter( llist_t * list, NodeWorkers_f Workers, unsigned segments,
+                                  NodeFilter_f NodeFilter,  unsigned user_data_filter,
+                                  NodeFilter_f NodeOperate, unsigned user_data_operate,
+                                  lbool_e detach, unsigned * match )
 {
-  lnode_t * node = LFirst(list);
-  unsigned match = 0;
+  lsegment_t * segment;
+  void **      tasks;
+  lnode_t *    node  = LFirst(list);
+  lnode_t *    chain = NULL;
+  lnode_t *    chain_last = NULL;
+  unsigned     count = LCount(list);
+  unsigned     i;
 
-  if (NodeOperate)
+  segment = (lsegment_t*)os_block_alloc_and_clear(segments * (sizeof(lsegment_t) + sizeof(void*)));
+  tasks   = (void**)(segment + segments);
+
+  /*
+   *  Split nodes evenly, the first segments get one extra node if needed.
+   */
+  for(i = 0; i < segments; i++)
     {
-      if (NodeFilter)
+      unsigned size = count / segments + (i < count % segments ? 1 : 0);
+
+      segment[i].first             = node;
+      segment[i].count             = size;
+      segment[i].NodeFilter        = NodeFilter;
+      segment[i].user_data_filter  = user_data_filter;
+      segment[i].NodeOperate       = NodeOperate;
+      segment[i].user_data_operate = user_data_operate;
+      segment[i].detach            = detach;
+      tasks[i] = &segment[i];
+
+      while(size--)
         {
-          while(node)
+          node = node->next;
+        }
+    }
+
+  Workers(LSegmentTask, tasks, segments);
+
+  *match = 0;
+
+  if (detach)
+    {
+      list->first = NULL;
+      list->last  = NULL;
+    }
+
+  for(i = 0; i < segments; i++)
+    {
+      *match += segment[i].match;
+
+      if (detach)
+        {
+          if (segment[i].keep_first)
             {
-              if (NodeFilter(node, user_data_filter))
+              segment[i].keep_first->prev = list->last;
+
+              if (list->last)
                 {
-                  lnode_t * operate = node;
-                  node = LNext(node);
-                  (void)NodeOperate(operate, user_data_operate);
-                  match++;
+                  list->last->next = segment[i].keep_first;
                 }
               else
                 {
-                  node = LNext(node);
+                  list->first = segment[i].keep_first;
                 }
+
+              list->last = segment[i].keep_last;
             }
-        }
-      else
-        {
-          while(node)
+
+          if (segment[i].match_first)
             {
-              lnode_t * operate = node;
-              node = LNext(node);
-              (void)NodeOperate(operate, user_data_operate);
-              match++;
+              segment[i].match_first->prev = chain_last;
+
+              if (chain_last)
+                {
+                  chain_last->next = segment[i].match_first;
+                }
+              else
+                {
+                  chain = segment[i].match_first;
+                }
+
+              chain_last = segment[i].match_last;
             }
         }
     }
 
-  return match;
+  if (detach)
+    {
+      list->count -= *match;
+
+      for(node = chain; node; node = node->next)
+        {
+          _LIndexRemove(list, node);
+        }
+    }
+
+  os_block_dealloc(segment);
+
+  return chain;
 }
 
 
 /*
- *  Count each list 1 node value found from list 2.
+ *  Parallel variant of LFilterCount.
  *
  */
-static unsigned LCompareValues( llist_t * list1, llist_t * list2, NodeCmp_f NodeCmp )
+unsigned LParallelFilterCount( llist_t * list, NodeFilter_f NodeFilter, unsigned user_data,
+                               NodeWorkers_f Workers, unsigned segments )
 {
-  unsigned  match = 0;
+  unsigned match;
 
-  /*
-   *  Following lists have match in values:
-   *  [1,5,3,3,1]  ==  [1,2,3,4,5,6]
-   */
-  LInitFor(lnode_t *, node1, list1)
+  if (!NodeFilter || !Workers || segments < 2 || LCount(list) < segments)
     {
-      LInitFor(lnode_t *, node2, list2)
-        {
-          if (NodeCmp(node1, node2) == LNODECMP_EQUAL)
-            {
-              match++;
+      return LFilterCount(list, NodeFilter, user_data);
+    }
+
+  (void)LParallelFilter(list, Workers, segments, NodeFilter, user_data, NULL, 0, LLIST_NO, &match);
+
+  return match;
+}
+
+
+/*
+ *  Parallel variant of LFilterRemove.
+ *
+ */
+unsigned LParallelFilterRemove( llist_t * list, NodeFilter_f NodeFilter, unsigned user_data,
+                                NodeWorkers_f Workers, unsigned segments )
+{
+  lnode_t * chain;
+  unsigned  match;
+
+  if (!NodeFilter || !Workers || segments < 2 || LCount(list) < segments)
+    {
+      return LFilterRemove(list, NodeFilter, user_data);
+    }
+
+  chain = LParallelFilter(list, Workers, segments, NodeFilter, user_data, NULL, 0, LLIST_YES, &match);
+
+  LDealloc(chain, list->clear_func, list->memorypool);
+
+  return match;
+}
+
+
+/*
+ *  Parallel variant of LFilterOperate.
+ *
+ */
+unsigned LParallelFilterOperate( llist_t * list, NodeFilter_f NodeFilter,  unsigned user_data_filter,
+                                                 NodeFilter_f NodeOperate, unsigned user_data_operate,
+                                 NodeWorkers_f Workers, unsigned segments )
+{
+  unsigned match;
+
+  if (!NodeOperate || !Workers || segments < 2 || LCount(list) < segments)
+    {
+      return LFilterOperate(list, NodeFilter, user_data_filter, NodeOperate, user_data_operate);
+    }
+
+  LSortInvalidate(list);
+
+  (void)LParallelFilter(list, Workers, segments, NodeFilter, user_data_filter,
+                        NodeOperate, user_data_operate, LLIST_NO, &match);
+
+  return match;
+}
+
+
+/*
+ *  Parallel variant of LFilterMove.
+ *
+ */
+void LParallelFilterMove( llist_t * list, llist_t ** other, NodeFilter_f NodeFilter, unsigned user_data,
+                          NodeWorkers_f Workers, unsigned segments )
+{
+  lnode_t * chain;
+  unsigned  match;
+
+  if (!NodeFilter || !Workers || segments < 2 || LCount(list) < segments)
+    {
+      LFilterMove(list, other, NodeFilter, user_data);
+      return;
+    }
+
+  if (!*other)
+    {
+      *other = LInit(list->node_size, list->clear_func, list->memorypool);
+    }
+
+  chain = LParallelFilter(list, Workers, segments, NodeFilter, user_data, NULL, 0, LLIST_YES, &match);
+
+  if (chain)
+    {
+      LAttachLast(*other, chain);
+    }
+}
+
+
+/*
+ *  Count number of nodes match to filter.
+ */
+unsigned LFilterCount( llist_t * list, NodeFilter_f NodeFilter, unsigned user_data)
+{
+  lnode_t * node = LFirst(list);
+  unsigned count = LCount(list);
+  unsigned match = 0;
+  lnode_t * ahead;
+  
+  if (NodeFilter)
+    {
+      _LAheadInit(ahead, node, LLOOP_FORWARD);
+
+      /*
+       *  Use unlooping to minimize while loop.
+       */
+      while(count > 10)
+        {
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+          count -= 10;
+        }
+
+      while(node)
+        {
+          match += NodeFilter(node, user_data);
+          node = LNext(node);
+          _LAheadStep(ahead, LLOOP_FORWARD);
+        }
+    }
+  else
+    {
+      match = count;
+    }
+
+  return match;
+}
+
+
+/*
+ *
+ *
+ */
+unsigned LFilterRemove( llist_t * list, NodeFilter_f NodeFilter, unsigned user_data )
+{
+  lnode_t * node = LFirst(list);
+  unsigned match = 0;
+
+  if (NodeFilter)
+    {
+      while(node)
+        {
+          if (NodeFilter(node, user_data))
+            {
+              lnode_t * remove = node;
+              node = LNext(node);
+              LRemove(list, remove);
+              match++;
+            }
+          else
+            {
+              node = LNext(node);
+            }
+        }
+    }
+
+  return match;
+}
+
+
+/*
+ *
+ *
+ */
+unsigned LFilterOperate( llist_t * list, NodeFilter_f NodeFilter,  unsigned user_data_filter,
+                                         NodeFilter_f NodeOperate, unsigned user_data_operate)
+{
+  lnode_t * node = LFirst(list);
+  unsigned match = 0;
+  lnode_t * ahead;
+
+  if (NodeOperate)
+    {
+      /* Operation may change the keys */
+      LSortInvalidate(list);
+
+      _LAheadInit(ahead, node, LLOOP_FORWARD);
+
+      if (NodeFilter)
+        {
+          while(node)
+            {
+              _LAheadStep(ahead, LLOOP_FORWARD);
+
+              if (NodeFilter(node, user_data_filter))
+                {
+                  lnode_t * operate = node;
+                  node = LNext(node);
+                  (void)NodeOperate(operate, user_data_operate);
+                  match++;
+                }
+              else
+                {
+                  node = LNext(node);
+                }
+            }
+        }
+      else
+        {
+          while(node)
+            {
+              lnode_t * operate = node;
+              node = LNext(node);
+              _LAheadStep(ahead, LLOOP_FORWARD);
+              (void)NodeOperate(operate, user_data_operate);
+              match++;
+            }
+        }
+    }
+
+  return match;
+}
+
+
+/*
+ *  Count each list 1 node value found from list 2.
+ *
+ */
+static unsigned LCompareValues( llist_t * list1, llist_t * list2, NodeCmp_f NodeCmp )
+{
+  unsigned  match = 0;
+
+  /*
+   *  Following lists have match in values:
+   *  [1,5,3,3,1]  ==  [1,2,3,4,5,6]
+   */
+  LInitFor(lnode_t *, node1, list1)
+    {
+      LInitFor(lnode_t *, node2, list2)
+        {
+          if (NodeCmp(node1, node2) == LNODECMP_EQUAL)
+            {
+              match++;
               break;
             }
         }
@@ -1503,6 +2900,11 @@ static unsigned LCompareNonOrder( llist_t * list1, llist_t * list2, NodeCmp_f No
 static unsigned LCompareInOrder( lnode_t * node1, lnode_t * node2, NodeCmp_f NodeCmp, lloop_e direction )
 {
   unsigned match = 0;
+  lnode_t * ahead1;
+  lnode_t * ahead2;
+
+  _LAheadInit(ahead1, node1, LLOOP_FORWARD);
+  _LAheadInit(ahead2, node2, direction);
 
   while(node1 && node2)
     {
@@ -1513,6 +2915,8 @@ static unsigned LCompareInOrder( lnode_t * node1, lnode_t * node2, NodeCmp_f Nod
 
       node1 = node1->next;
       node2 = LLoopNext(node2, direction);
+      _LAheadStep(ahead1, LLOOP_FORWARD);
+      _LAheadStep(ahead2, direction);
       match++;
     }
 
@@ -1521,129 +2925,351 @@ static unsigned LCompareInOrder( lnode_t * node1, lnode_t * node2, NodeCmp_f Nod
 
 
 /*
- *  Compares two linked lists and returns:
- *  - LLISTCMP_MATCH_INORDER    - List 1 match with list2 and in same order.
- *  - LLISTCMP_MATCH_REVERSE    - List 1 match with list2 and in reverse order.
- *  - LLISTCMP_MATCH_NONORDER   - List 1 match with list2 but in random order.
- *
- *  - LLISTCMP_MATCH_SUBSET     - List 1 match as strict  subset inside list 2.
- *  - LLISTCMP_MATCH_REVSUBSET  - List 1 match as reverse subset inside list 2.
- *  - LLISTCMP_MATCH_INCLUDED   - List 1 nodes all in list2 but in random order.
- *  - LLISTCMP_MATCH_COVERED    - List 1 node values all covered by list 2.
- *
- *  - LLISTCMP_MATCH_PARTIAL    - Only few nodes had match; considered no match.
- *  - LLISTCMP_MATCH_NOTHING    - None of the nodes match between lists.
+ *  Internal hash table slot for linear time node matching.
+ *  Table uses open addressing (linear probing) and slot
+ *  is free when node is NULL.
  */
-llistcmp_e LCompare( llist_t * list1, llist_t * list2, NodeCmp_f NodeCmp )
+typedef struct
 {
-  if (list1->count > 0)
-    {
-      unsigned match  = 0;
+  const lnode_t * node;
+  unsigned        hash;
+  unsigned        used;
+} lhashslot_t;
 
-      if (list1->count == list2->count)
-        {
-          /*
-           *  Check if list1 nodes all in list2 in same order.
-           */
-          match = LCompareInOrder(list1->first, list2->first, NodeCmp, LLOOP_FORWARD);
+typedef struct
+{
+  lhashslot_t * slots;
+  unsigned      mask;
+  void *        memorypool;
+} lhashtable_t;
 
-          if (match == list1->count)
-            {
-              return LLISTCMP_MATCH_INORDER;
-            }
 
-          match = LCompareInOrder(list1->first, list2->last, NodeCmp, LLOOP_BACKWARD);
 
-          if (match == list1->count)
-            {
-              return LLISTCMP_MATCH_REVERSE;
-            }
+/*
+ *  Allocate hash table for given amount of nodes (load factor below 50%).
+ *  Scratch memory is taken from given memory pool (which falls back to OS
+ *  for blocks bigger than pool block size) or from OS if pool is NULL.
+ *  Uses no_wait allocation, so that caller can fall back to other method.
+ */
+static lbool_e LHashInit( lhashtable_t * table, unsigned count, void * memorypool )
+{
+  unsigned size = 16;
 
-          /*
-           *  Check if list1 nodes all in list2 in any order.
-           */
-          match = LCompareNonOrder(list1, list2, NodeCmp);
+  while(size < count * 2)
+    {
+      size <<= 1;
+    }
 
-          if (match == list1->count)
-            {
-              return LLISTCMP_MATCH_NONORDER;
-            }
-          else if (match == 0)
-            {
-              return LLISTCMP_MATCH_NOTHING;
-            }
-        }
-      else if (list1->count < list2->count)
-        {
-          /*
-           *  Limit the search of subset based on its length.
-           */
-          unsigned count = list2->count - list1->count;
-          lnode_t * node = list2->first;
+  table->mask       = size - 1;
+  table->memorypool = memorypool;
 
-          while(count--)
+  if (memorypool)
+    {
+      table->slots = (lhashslot_t*)MPoolAllocFlexible(memorypool, size * sizeof(lhashslot_t),
+                                                      MPOOL_NOWAIT, MPOOL_ZERO_MEMSET);
+    }
+  else
+    {
+      table->slots = (lhashslot_t*)os_block_alloc_no_wait(size * sizeof(lhashslot_t));
+    }
+
+  /*
+   *  Cleared here, since pool clears only blocks of its own size.
+   */
+  if (table->slots)
+    {
+      (void)memset(table->slots, 0, size * sizeof(lhashslot_t));
+    }
+
+  return (table->slots ? LLIST_YES : LLIST_NO);
+}
+
+
+/*
+ *  Deallocate hash table.
+ *
+ */
+static void LHashFree( lhashtable_t * table )
+{
+  if (table->memorypool)
+    {
+      MPoolDealloc(table->memorypool, (void*)&table->slots);
+    }
+  else
+    {
+      os_block_dealloc(table->slots);
+    }
+
+  table->slots = NULL;
+}
+
+
+/*
+ *  Add node into hash table (duplicates allowed).
+ *
+ */
+static void LHashInsert( lhashtable_t * table, const lnode_t * node, unsigned hash )
+{
+  unsigned index = _LHashIndex(table, hash);
+
+  while(table->slots[index].node)
+    {
+      index = (index + 1) & table->mask;
+    }
+
+  table->slots[index].node = node;
+  table->slots[index].hash = hash;
+  table->slots[index].used = LLIST_NO;
+}
+
+
+/*
+ *  Find slot with node equal to given node, optionally
+ *  skipping slots already marked as used.
+ */
+static lhashslot_t * LHashFind( lhashtable_t * table, const lnode_t * node, unsigned hash,
+                                NodeCmp_f NodeCmp, lbool_e skip_used )
+{
+  unsigned index = _LHashIndex(table, hash);
+
+  while(table->slots[index].node)
+    {
+      lhashslot_t * slot = &table->slots[index];
+
+      if (slot->hash == hash && !(skip_used && slot->used))
+        {
+          if (NodeCmp(node, slot->node) == LNODECMP_EQUAL)
             {
-              /*
-               *  Check if list1 found in list2 in current positions.
-               */
-              match = LCompareInOrder(list1->first, node, NodeCmp, LLOOP_FORWARD);
+              return slot;
+            }
+        }
+
+      index = (index + 1) & table->mask;
+    }
+
+  return NULL;
+}
+
+
+/*
+ *  Count list1 nodes found in list 2 by hashing list 2 nodes.
+ *  If consume is set, each list 2 node can match only once
+ *  (as LCompareNonOrder), otherwise counts values (as LCompareValues).
+ */
+static unsigned LCompareHashCount( llist_t * list1, llist_t * list2, NodeCmp_f NodeCmp,
+                                   NodeHash_f NodeHash, lbool_e consume )
+{
+  lhashtable_t table;
+  unsigned     match = 0;
+
+  if (LHashInit(&table, LCount(list2), list2->memorypool) == LLIST_NO)
+    {
+      /*
+       *  Out of memory, use slower compare without allocations.
+       */
+      return consume ? LCompareNonOrder(list1, list2, NodeCmp) :
+                       LCompareValues(list1, list2, NodeCmp);
+    }
+
+  {
+    LInitFor(lnode_t *, node2, list2)
+      {
+        LHashInsert(&table, node2, NodeHash(node2));
+      }
+  }
+
+  {
+    LInitFor(lnode_t *, node1, list1)
+      {
+        lhashslot_t * slot = LHashFind(&table, node1, NodeHash(node1), NodeCmp, consume);
+
+        if (slot)
+          {
+            slot->used = LLIST_YES;
+            match++;
+          }
+      }
+  }
+
+  LHashFree(&table);
+
+  return match;
+}
+
+
+/*
+ *  Compares two linked lists and returns:
+ *  - LLISTCMP_MATCH_INORDER    - List 1 match with list2 and in same order.
+ *  - LLISTCMP_MATCH_REVERSE    - List 1 match with list2 and in reverse order.
+ *  - LLISTCMP_MATCH_NONORDER   - List 1 match with list2 but in random order.
+ *
+ *  - LLISTCMP_MATCH_SUBSET     - List 1 match as strict  subset inside list 2.
+ *  - LLISTCMP_MATCH_REVSUBSET  - List 1 match as reverse subset inside list 2.
+ *  - LLISTCMP_MATCH_INCLUDED   - List 1 nodes all in list2 but in random order.
+ *  - LLISTCMP_MATCH_COVERED    - List 1 node values all covered by list 2.
+ *
+ *  - LLISTCMP_MATCH_PARTIAL    - Only few nodes had match; considered no match.
+ *  - LLISTCMP_MATCH_NOTHING    - None of the nodes match between lists.
+ *
+ *  Compare options not in limit mask are skipped. If NodeHash is given,
+ *  non-ordered matches are counted with hash table in linear time.
+ */
+static llistcmp_e LCompareLists( llist_t * list1, llist_t * list2, NodeCmp_f NodeCmp,
+                                 NodeHash_f NodeHash, unsigned limit_mask )
+{
+  if (list1->count > 0)
+    {
+      unsigned match  = 0;
+
+      if (list1->count == list2->count)
+        {
+          /*
+           *  Check if list1 nodes all in list2 in same order.
+           */
+          if (limit_mask & LLISTCMP_MATCH_INORDER)
+            {
+              match = LCompareInOrder(list1->first, list2->first, NodeCmp, LLOOP_FORWARD);
 
               if (match == list1->count)
                 {
-                  return LLISTCMP_MATCH_SUBSET;
+                  return LLISTCMP_MATCH_INORDER;
                 }
+            }
+
+          if (limit_mask & LLISTCMP_MATCH_REVERSE)
+            {
+              match = LCompareInOrder(list1->first, list2->last, NodeCmp, LLOOP_BACKWARD);
 
-              node = node->next;
+              if (match == list1->count)
+                {
+                  return LLISTCMP_MATCH_REVERSE;
+                }
             }
 
           /*
-           *  Reverse subset search.
+           *  Check if list1 nodes all in list2 in any order.
            */
-          count = list2->count - list1->count;
-          node  = list2->last;
-
-          while(count--)
+          if (limit_mask & LLISTCMP_MATCH_NONORDER)
             {
-              /*
-               *  Check if list1 found in list2 in current positions.
-               */
-              match = LCompareInOrder(list1->first, node, NodeCmp, LLOOP_BACKWARD);
+              if (NodeHash)
+                {
+                  match = LCompareHashCount(list1, list2, NodeCmp, NodeHash, LLIST_YES);
+                }
+              else
+                {
+                  match = LCompareNonOrder(list1, list2, NodeCmp);
+                }
 
               if (match == list1->count)
                 {
-                  return LLISTCMP_MATCH_REVSUBSET;
+                  return LLISTCMP_MATCH_NONORDER;
                 }
+              else if (match == 0)
+                {
+                  return LLISTCMP_MATCH_NOTHING;
+                }
+            }
+        }
+      else if (list1->count < list2->count)
+        {
+          /*
+           *  Limit the search of subset based on its length.
+           */
+          unsigned count = list2->count - list1->count;
+          lnode_t * node = list2->first;
 
-              node = node->prev;
+          if (limit_mask & LLISTCMP_MATCH_SUBSET)
+            {
+              while(count--)
+                {
+                  /*
+                   *  Check if list1 found in list2 in current positions.
+                   */
+                  match = LCompareInOrder(list1->first, node, NodeCmp, LLOOP_FORWARD);
+
+                  if (match == list1->count)
+                    {
+                      return LLISTCMP_MATCH_SUBSET;
+                    }
+
+                  node = node->next;
+                }
             }
 
           /*
-           *  Check if list1 nodes all in list2 in any order.
+           *  Reverse subset search.
            */
-          match = LCompareNonOrder(list1, list2, NodeCmp);
-
-          if (match == list1->count)
+          if (limit_mask & LLISTCMP_MATCH_REVSUBSET)
             {
-              return LLISTCMP_MATCH_INCLUDED;
+              count = list2->count - list1->count;
+              node  = list2->last;
+
+              while(count--)
+                {
+                  /*
+                   *  Check if list1 found in list2 in current positions.
+                   */
+                  match = LCompareInOrder(list1->first, node, NodeCmp, LLOOP_BACKWARD);
+
+                  if (match == list1->count)
+                    {
+                      return LLISTCMP_MATCH_REVSUBSET;
+                    }
+
+                  node = node->prev;
+                }
             }
-          else if (match == 0)
+
+          /*
+           *  Check if list1 nodes all in list2 in any order.
+           */
+          if (limit_mask & LLISTCMP_MATCH_INCLUDED)
             {
-              return LLISTCMP_MATCH_NOTHING;
+              if (NodeHash)
+                {
+                  match = LCompareHashCount(list1, list2, NodeCmp, NodeHash, LLIST_YES);
+                }
+              else
+                {
+                  match = LCompareNonOrder(list1, list2, NodeCmp);
+                }
+
+              if (match == list1->count)
+                {
+                  return LLISTCMP_MATCH_INCLUDED;
+                }
+              else if (match == 0)
+                {
+                  return LLISTCMP_MATCH_NOTHING;
+                }
             }
         }
 
       /*
        *  Check if each list 1 node value is found from list 2.
        */
-      match = LCompareValues(list1, list2, NodeCmp);
-
-      if (match == list1->count)
-        {
-          return LLISTCMP_MATCH_COVERED;
-        }
-      else if (match > 0)
+      if (limit_mask & (LLISTCMP_MATCH_COVERED | LLISTCMP_MATCH_PARTIAL))
         {
-          return LLISTCMP_MATCH_PARTIAL;
+          if (NodeHash)
+            {
+              match = LCompareHashCount(list1, list2, NodeCmp, NodeHash, LLIST_NO);
+            }
+          else
+            {
+              match = LCompareValues(list1, list2, NodeCmp);
+            }
+
+          if (match == list1->count)
+            {
+              if (limit_mask & LLISTCMP_MATCH_COVERED)
+                {
+                  return LLISTCMP_MATCH_COVERED;
+                }
+            }
+          else if (match > 0 && (limit_mask & LLISTCMP_MATCH_PARTIAL))
+            {
+              return LLISTCMP_MATCH_PARTIAL;
+            }
         }
     }
 
@@ -1651,6 +3277,27 @@ llistcmp_e LCompare( llist_t * list1, llist_t * list2, NodeCmp_f NodeCmp )
 }
 
 
+/*
+ *  Compares two linked lists (see LCompareLists).
+ *
+ */
+llistcmp_e LCompare( llist_t * list1, llist_t * list2, NodeCmp_f NodeCmp, unsigned limit_mask )
+{
+  return LCompareLists(list1, list2, NodeCmp, NULL, limit_mask);
+}
+
+
+/*
+ *  Compares two linked lists using hash table for non-ordered matches.
+ *
+ */
+llistcmp_e LCompareHashed( llist_t * list1, llist_t * list2, NodeCmp_f NodeCmp,
+                           NodeHash_f NodeHash, unsigned limit_mask )
+{
+  return LCompareLists(list1, list2, NodeCmp, NodeHash, limit_mask);
+}
+
+
 /*
  *  Check if list contains the node.
  *
@@ -1721,6 +3368,52 @@ void LUnique( llist_t * list, NodeCmp_f NodeCmp, lloop_e direction )
 }
 
 
+/*
+ *  Remove duplicate nodes based on hash and compare functions in one pass.
+ *  Kept nodes are collected into temporary hash table, thus each node
+ *  is compared only against the nodes with same hash value.
+ */
+void LUniqueHashed( llist_t * list, NodeHash_f NodeHash, NodeCmp_f NodeCmp, lloop_e direction )
+{
+  if (NodeHash && NodeCmp && LCount(list) > 1)
+    {
+      lhashtable_t table;
+      lnode_t *    loop = LLoopHead(list, direction);
+
+      if (LHashInit(&table, LCount(list), list->memorypool) == LLIST_NO)
+        {
+          /*
+           *  Out of memory, use slower method without allocations.
+           */
+          LUnique(list, NodeCmp, direction);
+          return;
+        }
+
+      while(loop)
+        {
+          lnode_t * node = loop;
+          unsigned  hash = NodeHash(node);
+
+          loop = LLoopNext(loop, direction);
+
+          /*
+           *  First one from looping direction is kept.
+           */
+          if (LHashFind(&table, node, hash, NodeCmp, LLIST_NO))
+            {
+              LRemove(list, node);
+            }
+          else
+            {
+              LHashInsert(&table, node, hash);
+            }
+        }
+
+      LHashFree(&table);
+    }
+}
+
+
 /*
  *  Get index number for node in the list.
  *
@@ -1839,6 +3532,10 @@ int LLastIndex( llist_t * list )
  */
 lnode_t * LFindNode( lnode_t * start_node, NodeFilter_f NodeFilter, unsigned user_data, lloop_e direction )
 {
+  lnode_t * ahead;
+
+  _LAheadInit(ahead, start_node, direction);
+
   while(start_node)
     {
       if (NodeFilter(start_node, user_data) == LLIST_YES)
@@ -1850,6 +3547,7 @@ lnode_t * LFindNode( lnode_t * start_node, NodeFilter_f NodeFilter, unsigned use
         }
 
       start_node = LLoopNext(start_node, direction);
+      _LAheadStep(ahead, direction);
     }
 
   /* no match */
@@ -1891,6 +3589,11 @@ lnode_t * LFindPair( lnode_t * start_node, NodeCmp_f NodeCmp, lnode_t * match_no
  *   allowing one to compare several structure members and use range checking)
  *
  *  NOTE: Currently not introduced in header file as public function! (Will be removed?)
+ *
+ *  Scan stays node by node: it starts from any node in either direction without
+ *  the list object, and compares members of any size, thus there is no version
+ *  to keep a column valid by. Repeated searches of int member in whole list
+ *  should use lcolumn_t (LColumnFind with low == high) instead.
  */
 static lnode_t * LFindValue( lnode_t * start_node, unsigned offset, signed int value, unsigned size, lloop_e direction )
 {
@@ -1971,46 +3674,116 @@ static lnode_t * LFindData( lnode_t * start_node, unsigned offset, const char *
 }
 
 
+/*
+ *  Internal xoshiro128** generator for shuffling (state must not be all zeroes).
+ *
+ */
+static unsigned lshuffle_state[4] = { 0x9E3779B9u, 0x243F6A88u, 0xB7E15162u, 0x85A308D3u };
+
+#define _LRotate( x, k )  (((x) << (k)) | ((x) >> (32 - (k))))
+
+static unsigned LShuffleRandom( void )
+{
+  unsigned * s = lshuffle_state;
+  unsigned result = _LRotate(s[1] * 5, 7) * 9;
+  unsigned t = s[1] << 9;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3]  = _LRotate(s[3], 11);
+
+  return result;
+}
+
+
+/*
+ *  Seed the internal randomizer of LShuffle (same seed gives same order).
+ *
+ */
+void LShuffleSeed( unsigned seed )
+{
+  unsigned i;
+
+  /*
+   *  Expand seed to state with splitmix32 steps,
+   *  which never produces all zeroes state.
+   */
+  for(i = 0; i < 4; i++)
+    {
+      unsigned z = (seed += 0x9E3779B9u);
+      z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+      z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+      lshuffle_state[i] = z ^ (z >> 16);
+    }
+}
+
+
 /*
  *  Shuffle node order with given randomizer (e.g. rand()),
- *  or internal "quick and dirty" method if NULL is given.
+ *  or internal xoshiro128** generator if NULL is given.
  */
 void LShuffle( llist_t * list, int (*randomizer)(void) )
 {
-  if (LCount(list) > 1)
-    {
-      lnode_t * node1 = LFirst(list);
-      lnode_t * node2 = LFirst(list);
+  unsigned count = LCount(list);
 
-      static int random = 0;
-      int loop = LCount(list) * 2;
+  if (count > 1)
+    {
+      lnode_t ** nodes = (lnode_t**)os_block_alloc_no_wait(count * sizeof(lnode_t*));
+      unsigned   i     = 0;
 
-      random += (randomizer ? randomizer() : (int)list);
-      node2   = LGetNode(list, (int)(((unsigned)random) % LCount(list)));
+      _LIndexBreak(list);
 
-      while(--loop)
+      if (nodes)
         {
           /*
-           *  Next to be swapped is the next of previously randomized.
-           *  (Optimization to prevent randomizing and fecthing both nodes)
+           *  Collect nodes into array and shuffle it with Fisher-Yates.
            */
-          if (node2->next)
+          LInitFor(lnode_t*, node, list)
             {
-              node1 = node2->next;
+              nodes[i++] = node;
             }
-          else
+
+          for(i = count - 1; i > 0; i--)
             {
-              node1 = list->first;
+              unsigned  random = (randomizer ? (unsigned)randomizer() : LShuffleRandom());
+              unsigned  pick   = random % (i + 1);
+              lnode_t * swap   = nodes[i];
+              nodes[i]    = nodes[pick];
+              nodes[pick] = swap;
             }
 
           /*
-           *  Another node to be swapped is randomized.
+           *  Relink the whole list once in the new order.
            */
-          random += (randomizer ? randomizer() : random | (int)node1 + (int)node2);
-          node2   = LGetNode(list, (int)(((unsigned)random) % LCount(list)));
+          nodes[0]->prev = NULL;
 
-          LSwapInside(list, node1, node2);
-        }
+          for(i = 1; i < count; i++)
+            {
+              nodes[i-1]->next = nodes[i];
+              nodes[i]->prev   = nodes[i-1];
+            }
+
+          nodes[count-1]->next = NULL;
+          list->first = nodes[0];
+          list->last  = nodes[count-1];
+
+          os_block_dealloc(nodes);
+        }
+      else
+        {
+          /*
+           *  Out of memory, so shuffle by moving random nodes in place
+           *  to the end of list (slower, since nodes fetched by index).
+           */
+          for(i = count; i > 1; i--)
+            {
+              unsigned random = (randomizer ? (unsigned)randomizer() : LShuffleRandom());
+              LMoveLast(list, LGetNode(list, (int)(random % i)));
+            }
+        }
     }
 }
 
@@ -2023,6 +3796,11 @@ lbool_e LVerify(  llist_t * list, NodeCmp_f NodeCmp )
 {
   unsigned result = LLIST_YES; /* List in order */
 
+  if (list->sortedby == NodeCmp && NodeCmp)
+    {
+      return LLIST_YES;
+    }
+
   if (LCount(list) > 1)
     {
       lnode_t* node = list->first;
@@ -2039,6 +3817,7 @@ lbool_e LVerify(  llist_t * list, NodeCmp_f NodeCmp )
       else if (LCount(list) > 2)
         {
           lnode_t * head = node;
+          lnode_t * ahead;
 
           /*
            *  First one was checked already, so remove it temporarely.
@@ -2049,6 +3828,8 @@ lbool_e LVerify(  llist_t * list, NodeCmp_f NodeCmp )
            *  Continue from the end of the list.
            */
           node = list->last->prev;
+
+          _LAheadInit(ahead, node, LLOOP_BACKWARD);
     
           while(node)
             {
@@ -2059,6 +3840,7 @@ lbool_e LVerify(  llist_t * list, NodeCmp_f NodeCmp )
                 }
     
               node = node->prev;
+              _LAheadStep(ahead, LLOOP_BACKWARD);
             }
 
           /*
@@ -2068,1076 +3850,3227 @@ lbool_e LVerify(  llist_t * list, NodeCmp_f NodeCmp )
         }
     }
 
+  if (result == LLIST_YES)
+    {
+      list->sortedby = NodeCmp;
+    }
+
   return result;
 }
 
 
 /*
- *  Sorts the list according to given compare function.
- *
+ *  Adaptive merge sort (see the description after LSort).
+ *  ^^^^^^^^^^^^^^^^^^^
+ *  Runs are chains of nodes linked by next only (prev links are set
+ *  once after the sort), terminated by NULL.
  */
-void LSort( llist_t * list, NodeCmp_f NodeCmp )
+#define LSORT_MAX_RUNS   64  /* Enough for 2^32 nodes by stack invariants */
+#define LSORT_GALLOP     7   /* Wins in a row before galloping            */
+
+typedef struct
 {
-  if (NodeCmp && LCount(list) > 1)
+  lnode_t * first;
+  lnode_t * last;
+  unsigned  count;
+
+} lsortrun_t;
+
+#define _LSortBefore( node, key, NodeCmp, equal ) \
+    ((equal) ? NodeCmp(node, key) <= LNODECMP_EQUAL : NodeCmp(node, key) < LNODECMP_EQUAL)
+
+
+/*
+ *  Minimum run length (32...64) so that n / minrun is (close to) power of two.
+ */
+static unsigned LSortMinRun( unsigned count )
+{
+  unsigned rest = 0;
+
+  while(count >= 64)
     {
-      llist_t tlist = {NULL, NULL, NULL, 0, 0};
-      llist_t blist = {NULL, NULL, NULL, 0, 0};
-      lnode_t* highnode = LFirst(list);
-      lnode_t* lownode  = LFirst(list);
-      lnode_t* node     = LFirst(list);
-      unsigned count    = LCount(list);
+      rest  |= count & 1;
+      count >>= 1;
+    }
 
-      /*
-       *  Optimization: add sentinel node to speed up
-       *  attach operations to top and bottomlists.
-       */
-      lnode_t sentinel  = {NULL, NULL};
-      tlist.last  = &sentinel;
-      tlist.first = &sentinel;
-      blist.first = &sentinel;
-      blist.last  = &sentinel;
+  return count + rest;
+}
 
-      /*
-       *  Sort linked list with double insertion sort.
-       */
-      while(node)
-        {
-          node = node->next;
-          /*
-           *  Loop the (remaining) list through and
-           *  find lowest and highest nodes.
-           */
-          while(node)
-            {
-              if (NodeCmp(node, highnode) >= LNODECMP_EQUAL)
-                {
-                  highnode = node;
-                }
-              else if (NodeCmp(node, lownode) < LNODECMP_EQUAL)
-                {
-                  lownode = node;
-                }
 
-              node = node->next;
-            }
+/*
+ *  Gallop over chain from node (known to go before key) and return the last
+ *  node before key (or equal with key if told), with exponential and then
+ *  binary search, thus long blocks are passed with log compares.
+ */
+static lnode_t * LSortGallop( lnode_t * node, const lnode_t * key, NodeCmp_f NodeCmp, lbool_e equal )
+{
+  unsigned step = 1;
 
-          /*
-           *  Detach highest node from linked list and attach as
-           *  first of botton list    [ "7" -> ...,8,9,BOTTOM]
-           */
-          LDetach(list, highnode);
+  for(;;)
+    {
+      lnode_t * probe = node;
+      unsigned  count = 0;
 
-          /*
-           *  Inline solution of LAttachFirst( blist, highnode );
-           *  (last)->next & prev<-(first)
-           */
-          highnode->next = blist.first;
-          blist.first->prev = highnode;
-          blist.first = highnode;
+      while(count < step && probe->next)
+        {
+          probe = probe->next;
+          count++;
+        }
 
-          if (highnode != lownode)
-            {
-              /*
-               *  Detach lowest node from linked list and attach as
-               *  last of top list    [TOP,1,2,...  <- "3" ]
-               */
-              LDetach(list, lownode);
+      if (!count)
+        {
+          return node;
+        }
 
-              /*
-               *  Inline solution of LAttachLast( tlist, lownode );
-               *  (last)->next & prev<-(node)
-               */
-              lownode->prev = tlist.last;
-              tlist.last->next = lownode;
-              tlist.last = lownode;
+      if (_LSortBefore(probe, key, NodeCmp, equal))
+        {
+          node = probe;
+
+          if (count < step)
+            {
+              return node;
             }
 
-          node     = list->first;
-          highnode = node;
-          lownode  = node;
+          step <<= 1;
+          continue;
         }
 
       /*
-       *  Remove the sentinel node references.
+       *  Binary search from the nodes between node and probe.
        */
-      tlist.first = tlist.first->next;
-      tlist.first->prev = NULL;
-      blist.last  = blist.last->prev;
-      blist.last->next  = NULL;
+      count--;
 
-      /*
-       *  Finally join top and bottom back to orginal list.
-       *  LIST = [TOP,1,2,3,4,...] + [...,5,6,7,8,9,BOTTOM]
-       */
-      LAttachLast(list, tlist.first);
-      LAttachLast(list, blist.first);
+      while(count)
+        {
+          unsigned  half = (count + 1) / 2;
+          unsigned  i;
+
+          probe = node;
+
+          for(i = 0; i < half; i++)
+            {
+              probe = probe->next;
+            }
+
+          if (_LSortBefore(probe, key, NodeCmp, equal))
+            {
+              node   = probe;
+              count -= half;
+            }
+          else
+            {
+              count = half - 1;
+            }
+        }
+
+      return node;
     }
 }
 
 
 /*
- * Sorting method used is demonstrated below:
- *
- * [ 5, 6A, 2A, 7, 9, 6B, 2B, 6C, 8, 3, 1, 4, 5] <- orginal
- *
- *                                                        top-stack       botton-stack
- * [ 5, 6A, 2A, 7,*9, 6B, 2B, 6C, 8, 3,*1, 4, 5] ->  [1,..            +               ..,9]
- * [ 5, 6A,*2A, 7,    6B, 2B, 6C,*8, 3,    4, 5] ->  [1,2A,..         +             ..,8,9]
- * [ 5, 6A,   *7,     6B,*2B, 6C,    3,    4, 5] ->  [1,2A,2B,..      +           ..,7,8,9]
- * [ 5, 6A,           6B,    *6C,   *3,    4, 5] ->  [1,2A,2B,3,..    +        ..,6C,7,8,9]
- * [ 5, 6A           *6B,                 *4, 5] ->  [1,2A,2B,3,4,..  +     ..,6B,6C,7,8,9]
- * [*5,*6A                                    5] ->  [1,2A,2B,3,4,5,..+  ..,6A,6B,6C,7,8,9]
- * [                                         *5] ->  [1,2A,2B,3,4,5,..+..,5,6A,6B,6C,7,8,9]
- *
- * [ 1, 2A, 2B, 3, 4, 5, 5, 6A, 6B, 6C, 7, 8, 9] <- sorted
- *
- * - 6A, 6B, 6C are all equal, and they remain their orginal order in botton-stack, as well
- *   2A and 2B are equal and remain their order in top-stack, thus algorithm is stable.
- * - worst case scenario is if list is in reverse order, best case if already in order.
- *
+ *  Merge run2 into run1 (run1 being first in the list). Run which wins
+ *  several compares in a row is galloped over, and equal nodes of run1
+ *  are taken first, thus merging is stable.
  */
+static void LSortMerge( lsortrun_t * run1, lsortrun_t * run2, NodeCmp_f NodeCmp )
+{
+  lnode_t   head;
+  lnode_t * tail  = &head;
+  lnode_t * node1 = run1->first;
+  lnode_t * node2 = run2->first;
+  unsigned  wins1 = LSORT_GALLOP - 1;
+  unsigned  wins2 = LSORT_GALLOP - 1;
 
+  run1->count += run2->count;
 
-/*
- *  Rearrange linked list in reverse order.
- *
- */
-void LReverse( llist_t * list )
-{
-  if (LCount(list) > 1)
+  /*
+   *  Runs already in order are just concatenated.
+   */
+  if (NodeCmp(run1->last, node2) <= LNODECMP_EQUAL)
     {
-      lnode_t * next = list->first->next;
-      lnode_t * node = list->first->next;
-      list->last     = list->first;
+      run1->last->next = node2;
+      run1->last       = run2->last;
+      return;
+    }
 
-      while(node)
+  while(node1 && node2)
+    {
+      lnode_t * last;
+
+      if (NodeCmp(node1, node2) <= LNODECMP_EQUAL)
         {
-          next = node->next;
+          last  = (++wins1 >= LSORT_GALLOP ? LSortGallop(node1, node2, NodeCmp, LLIST_YES) : node1);
+          wins2 = 0;
 
-          node->next = list->first;
-          list->first->prev = node;
-          list->first = node;
+          tail->next = node1;
+          node1 = last->next;
+        }
+      else
+        {
+          last  = (++wins2 >= LSORT_GALLOP ? LSortGallop(node2, node1, NodeCmp, LLIST_NO) : node2);
+          wins1 = 0;
 
-          node = next;
+          tail->next = node2;
+          node2 = last->next;
         }
 
-      list->first->prev = NULL;
-      list->last->next  = NULL;
+      tail = last;
     }
-}
 
+  if (node1)
+    {
+      tail->next = node1;
+    }
+  else
+    {
+      tail->next = node2;
+      run1->last = run2->last;
+    }
 
-/*
- * Internal typacast for expanded nodes.
- *   
- */
-typedef struct 
-  { 
-    LLIST_NODE
-    unsigned offset;
-  } lnode_offset_t;
+  run1->first = head.next;
+}
 
 
 /*
- *  Calculate new size and offset to add lnode_t fields at the end.
- *
+ *  Take the next run from chain: ascending, or strictly descending which
+ *  is reversed, and extended up to minrun nodes by insertion.
  */
-unsigned LExpandedSize( unsigned * size )
+static lnode_t * LSortRun( lnode_t * node, lsortrun_t * run, unsigned minrun, NodeCmp_f NodeCmp )
 {
-  /*
-   *  Correct alingment by 4 (just in case, since sizeof is
-   *  always aligned by 4 in C) and increase the node size.
-   */
-  unsigned offset = *size;
+  lnode_t * next = node->next;
 
-  if ((*size % 4) != 0)
+  run->first = node;
+  run->last  = node;
+  run->count = 1;
+  node->next = NULL;
+
+  if (next && NodeCmp(node, next) > LNODECMP_EQUAL)
     {
-      offset = *size + 4 - (*size % 4);
+      while(next && NodeCmp(run->first, next) > LNODECMP_EQUAL)
+        {
+          node       = next;
+          next       = node->next;
+          node->next = run->first;
+          run->first = node;
+          run->count++;
+        }
     }
+  else
+    {
+      while(next && NodeCmp(run->last, next) <= LNODECMP_EQUAL)
+        {
+          run->last->next = next;
+          run->last       = next;
+          next            = next->next;
+          run->count++;
+        }
 
-  *size = offset +  sizeof(lnode_offset_t);
-
-  return offset;
-}
+      run->last->next = NULL;
+    }
 
+  /*
+   *  Short run is extended by insertion (after equal nodes).
+   */
+  while(next && run->count < minrun)
+    {
+      node = next;
+      next = node->next;
 
-/*
- *  Typecast object to lnode with given offset.
- *
- */
-lnode_t * LCastNode( void * object, unsigned offset )
-{
-  lnode_offset_t * offset_node =
-      (lnode_offset_t*)&(*(char**)((char*)(object) + offset));
+      if (NodeCmp(run->last, node) <= LNODECMP_EQUAL)
+        {
+          run->last->next = node;
+          run->last       = node;
+          node->next      = NULL;
+        }
+      else if (NodeCmp(run->first, node) > LNODECMP_EQUAL)
+        {
+          node->next = run->first;
+          run->first = node;
+        }
+      else
+        {
+          lnode_t * after = run->first;
 
-  offset_node->next   = NULL;
-  offset_node->prev   = NULL;
-  offset_node->offset = offset;
+          while(NodeCmp(after->next, node) <= LNODECMP_EQUAL)
+            {
+              after = after->next;
+            }
 
-  return (lnode_t*)offset_node;
-}
+          node->next  = after->next;
+          after->next = node;
+        }
 
+      run->count++;
+    }
 
-/*
- *  Typecast node back to object by stored offset.
- *
- */
-void * LCastObject( lnode_t* node )
-{
-  return &(*(char**)((char*)(node) - ((lnode_offset_t*)node)->offset));
+  return next;
 }
 
 
 /*
- *  Deallocate Expanded.
+ *  Sorts the list according to given compare function.
  *
  */
-lnode_t * LExpandedDealloc( lnode_t * node )
+void LSort( llist_t * list, NodeCmp_f NodeCmp )
 {
-  void * object = LCastObject( node );
-  os_block_dealloc(object);
-  return NULL;
-}
+  if (!NodeCmp || list->sortedby == NodeCmp)
+    {
+      return;
+    }
 
+  if (LCount(list) > 1)
+    {
+      lsortrun_t runs[LSORT_MAX_RUNS];
+      unsigned   size   = 0;
+      unsigned   minrun = LSortMinRun(LCount(list));
+      lnode_t *  node   = list->first;
+      lnode_t *  prev   = NULL;
 
-/* --------------------------------------------------------------- */
+      /*
+       *  Sorting keeps the same nodes in list, thus key index stays valid.
+       */
+      _LIndexBreak(list);
 
-#if defined LLIST_UNITTEST || defined MPOOL_UNITTEST
+      while(node)
+        {
+          node = LSortRun(node, &runs[size++], minrun, NodeCmp);
 
-/*
- *  gcc -fprofile-arcs -ftest-coverage -DLLIST_UNITTEST -o llist.exe llist.c
- *
- *  Test coverage (100%):
- *  ./llist.exe
- *  gcov llist.c
- *
- *  Memory leaks (0 bytes):
- *  valgrind ./llist.exe
- */
+          /*
+           *  Merge the runs on stack until each run is longer than
+           *  the two runs after it together, and longer than the next.
+           */
+          while(size > 1)
+            {
+              unsigned n = size - 2;
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdarg.h>
-#include <time.h>
+              if ((n > 0 && runs[n - 1].count <= runs[n].count + runs[n + 1].count) ||
+                  (n > 1 && runs[n - 2].count <= runs[n - 1].count + runs[n].count))
+                {
+                  if (runs[n - 1].count < runs[n + 1].count)
+                    {
+                      n--;
+                    }
+                }
+              else if (runs[n].count > runs[n + 1].count)
+                {
+                  break;
+                }
 
-static unsigned os_block_alloc_occupied = LLIST_NO;
+              LSortMerge(&runs[n], &runs[n + 1], NodeCmp);
 
-static void * os_block_alloc(unsigned size)
-{
-  return memcpy(malloc(size), "deadbeef", 8);
-}
+              for(n++, size--; n < size; n++)
+                {
+                  runs[n] = runs[n + 1];
+                }
+            }
+        }
 
-static void * os_block_alloc_and_clear(unsigned size)
-{
-  return memset(malloc(size), 0, size);
-}
+      while(size > 1)
+        {
+          unsigned n = size - 2;
 
-static void * os_block_alloc_no_wait(unsigned size)
-{
-  return (os_block_alloc_occupied ? NULL : os_block_alloc(size));
-}
+          if (n > 0 && runs[n - 1].count < runs[n + 1].count)
+            {
+              n--;
+            }
 
-static void os_block_dealloc(void* ptr)
-{
-  free(ptr);
-}
+          LSortMerge(&runs[n], &runs[n + 1], NodeCmp);
 
+          for(n++, size--; n < size; n++)
+            {
+              runs[n] = runs[n + 1];
+            }
+        }
+
+      /*
+       *  Restore the prev links.
+       */
+      list->first = runs[0].first;
+      list->last  = runs[0].last;
+      node        = list->first;
+
+      while(node)
+        {
+          node->prev = prev;
+          prev = node;
+          node = node->next;
+        }
+    }
+
+  list->sortedby = NodeCmp;
+}
 
-#elif defined LLIST_UNITTEST
 
 /*
- *  Test structure
+ *  Set operations for sorted lists.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *  Both lists are merged in one pass, and nodes are only moved between
+ *  the lists: result is left into list and the rest of the nodes into
+ *  other list, both in sorted order. Equal nodes are paired one to one,
+ *  thus lists with duplicates work as multisets.
  *
+ *  operation   list only   other only   paired list node
+ *  union       keep        to list      keep
+ *  intersect   to other    keep         keep
+ *  diff        keep        keep         to other
+ *  symdiff     keep        to list      to other
  */
-typedef struct
-{
-  LLIST_NODE
-  int    id;
-  int    value;
-  char * string;
-} test_record_t;
-
+#define LSET_KEEP_LIST   1  /* List nodes without pair stay in list       */
+#define LSET_TAKE_OTHER  2  /* Other nodes without pair are moved to list */
+#define LSET_KEEP_PAIRED 4  /* List nodes with pair stay in list          */
 
-static void unittest_show(char * name, llist_t * list)
+static void LSetMerge( llist_t * list, llist_t * other, NodeCmp_f NodeCmp, unsigned mode )
 {
-  if (list)
+  lnode_t * node1 = LFirst(list);
+  lnode_t * node2 = LFirst(other);
+
+  while(node1 && node2)
     {
-      test_record_t * record = NULL;
-      lnode_t * node = LFirst(list);
-      lnode_t * prev = NULL;
-      unsigned count = 0;
+      signed int result = NodeCmp(node1, node2);
+      lnode_t *  next;
 
-      printf("%s List, with %d nodes:\n", name, LCount(list));
+      if (result < LNODECMP_EQUAL)
+        {
+          next = node1->next;
 
-      if (!node) printf("no nodes\n"); else
+          if (!(mode & LSET_KEEP_LIST))
+            {
+              LSpliceRange(other, node2->prev, list, node1, node1, 1);
+            }
+
+          node1 = next;
+        }
+      else if (result > LNODECMP_EQUAL)
         {
-          assert(!LPrev(LFirst(list)));     /* 1. verify head of list */
-          assert(!LNext(LLast(list)));      /* 2. verify tail of list */
+          next = node2->next;
 
-          while(node)
+          if (mode & LSET_TAKE_OTHER)
             {
-              assert(LPrev(node) == prev);  /* 3. verify backward linking ... */
-              prev   = node;
-              record = (test_record_t*)node;
-              node   = LNext(node);         /* 4. ... while using forward linking */
-              count++;
+              LSpliceRange(list, node1->prev, other, node2, node2, 1);
+            }
 
-              printf("element id=%d, value=%d\n", record->id, record->value);
+          node2 = next;
+        }
+      else
+        {
+          next = node1->next;
+
+          if (!(mode & LSET_KEEP_PAIRED))
+            {
+              /* paired node is placed before its pair */
+              LSpliceRange(other, node2->prev, list, node1, node1, 1);
             }
+
+          node1 = next;
+          node2 = node2->next;
         }
-      assert(LCount(list) == count);        /* 5. verify list count */
     }
-  else
+
+  /*
+   *  Rest of the nodes have no pair.
+   */
+  if (node1 && !(mode & LSET_KEEP_LIST))
     {
-      printf("no list\n");
+      LSpliceRange(other, LLast(other), list, node1, LLast(list), 0);
     }
 
-  printf("-------------\n");
-}
+  if (node2 && (mode & LSET_TAKE_OTHER))
+    {
+      LSpliceRange(list, LLast(list), other, node2, LLast(other), 0);
+    }
 
-static signed int unittest_compare(const lnode_t* node1, const lnode_t* node2)
-{
-  return (signed int)(((test_record_t*)node1)->value - ((test_record_t*)node2)->value);
+  list->sortedby  = NodeCmp;
+  other->sortedby = NodeCmp;
 }
 
-static lbool_e unittest_filter(const lnode_t* node, unsigned user_data)
+
+/*
+ *
+ *
+ */
+void LSetUnion( llist_t * list, llist_t * other, NodeCmp_f NodeCmp )
 {
-  return (((test_record_t*)node)->value > (int)user_data ? LLIST_YES : LLIST_NO);
+  LSetMerge(list, other, NodeCmp, LSET_KEEP_LIST | LSET_TAKE_OTHER | LSET_KEEP_PAIRED);
 }
 
-static lbool_e unittest_operate(const lnode_t* node, unsigned user_data)
-{
-  printf("Operating node %d by increasing value %d by %d\n", 
-    ((test_record_t*)node)->id, ((test_record_t*)node)->value, user_data);
 
-  ((test_record_t*)node)->value += user_data;
-  return LLIST_YES; /* meaningless */
+/*
+ *
+ *
+ */
+void LSetIntersect( llist_t * list, llist_t * other, NodeCmp_f NodeCmp )
+{
+  LSetMerge(list, other, NodeCmp, LSET_KEEP_PAIRED);
 }
 
-static lnode_t* unittest_clone(const lnode_t* node, unsigned user_data)
+
+/*
+ *
+ *
+ */
+void LSetDiff( llist_t * list, llist_t * other, NodeCmp_f NodeCmp )
 {
-  test_record_t* newrecord = (test_record_t*)os_block_alloc(sizeof(test_record_t));
-  newrecord->id    = ((test_record_t*)node)->id;
-  newrecord->value = ((test_record_t*)node)->value + user_data;
-  return (lnode_t*)newrecord;
+  LSetMerge(list, other, NodeCmp, LSET_KEEP_LIST);
 }
 
-static lnode_t * unittest_free(lnode_t* node)
+
+/*
+ *
+ *
+ */
+void LSetSymDiff( llist_t * list, llist_t * other, NodeCmp_f NodeCmp )
 {
-  printf("free any allocated data node %d might possess.\n",
-      ((test_record_t*)node)->id);
-  return node;
+  LSetMerge(list, other, NodeCmp, LSET_KEEP_LIST | LSET_TAKE_OTHER);
 }
 
-static llist_t * unittest_generate_list( unsigned count, ... )
-{
-  llist_t * list = LInit(sizeof(test_record_t), NULL, NULL);
-  test_record_t * record;
-  va_list valuelist;
-  unsigned i = 0;
 
-  va_start(valuelist, count);
+/*
+ *  Binary heap of list positions for k-way merge, ordered by
+ *  the current head node of each list (ties by list position,
+ *  to keep the merge stable).
+ */
+#define _LHeapLess( heads, a, b, NodeCmp ) \
+    ( (result = NodeCmp((heads)[a], (heads)[b])) < LNODECMP_EQUAL || (result == LNODECMP_EQUAL && (a) < (b)) )
 
-  while(i < count)
+static void LHeapSiftDown( lnode_t ** heads, unsigned * heap, unsigned size, unsigned pos, NodeCmp_f NodeCmp )
+{
+  unsigned   item = heap[pos];
+  signed int result;
+
+  for(;;)
     {
-      record = (test_record_t*)LCreateLast(list);
-      record->id = ++i;
-      record->value = va_arg(valuelist, int);
-    }
+      unsigned child = pos * 2 + 1;
 
-  va_end(valuelist);
+      if (child >= size)
+        {
+          break;
+        }
 
-  return list;
-}
+      if (child + 1 < size && _LHeapLess(heads, heap[child + 1], heap[child], NodeCmp))
+        {
+          child++;
+        }
 
-static void unittest_dispose_all( llist_t * list, ... )
-{
-  va_list lists;
-  va_start(lists, list);
+      if (!_LHeapLess(heads, heap[child], item, NodeCmp))
+        {
+          break;
+        }
 
-  while(list != NULL) 
-    {
-      LDispose(&list);
-      list = va_arg(lists, llist_t *);
+      heap[pos] = heap[child];
+      pos = child;
     }
 
-  va_end(lists);
+  heap[pos] = item;
 }
 
-/* ------ Testset 1 - create nodes ------ */
 
-/* Output:
- *
- *  List, with 4 nodes:
- *  element id = 3, value = 333
- *  element id = 4, value = 4444
- *  element id = 1, value = 1
- *  element id = 2, value = 22
- *
+/*
+ *  Merge k sorted lists into the first list in O(n log k) compares.
+ *  Nodes are relinked, other lists are left empty.
  */
-static void unittest_testset1( void )
+void LMergeK( llist_t * lists[], unsigned k, NodeCmp_f NodeCmp )
 {
-  llist_t * list  = LInit( sizeof(test_record_t), NULL, NULL );
-  llist_t * list2 = LInit( sizeof(test_record_t), unittest_free, NULL );
-  test_record_t * record = NULL;
-  lnode_t * node;
-
-  printf("\nTestset 1 - create nodes.\n\n");
+  llist_t *  list = lists[0];
+  lnode_t ** heads;
+  unsigned * heap;
+  unsigned   size  = 0;
+  unsigned   count = 0;
+  lnode_t *  last  = NULL;
+  unsigned   i;
+
+  if (k < 2)
+    {
+      return;
+    }
 
-  record = (test_record_t*)LCreateFirst(list);
-  assert(list->count == 1);
-  assert(!list->last->next);
-  assert(!list->first->prev);
-  LRemove(list, (lnode_t*)record);
-  assert(list->count == 0);
+  heads = (lnode_t**)os_block_alloc(k * (sizeof(lnode_t*) + sizeof(unsigned)));
+  heap  = (unsigned*)(heads + k);
 
-  record = (test_record_t*)LCreateLast(list);
-  record->id = 1;
-  record->value = 1;
+  _LIndexBreak(list);
 
-  record = (test_record_t*)LCreateLast(list);
-  record->id = 2;
-  record->value = 22;
+  for(i = 0; i < k; i++)
+    {
+      heads[i] = LFirst(lists[i]);
+      count   += LCount(lists[i]);
 
-  record = (test_record_t*)LCreateFirst(list);
-  record->id = 3;
-  record->value = 333;
+      if (i > 0)
+        {
+          LSortIndexDisable(lists[i]);
+          LHashIndexDisable(lists[i]);
 
-  node = LCreateBefore(list, LFirst(list));
-  LRemove(list, node);
+          if (heads[i])
+            {
+              _LIndexAdd(list, heads[i]);
+            }
 
-  node = LCreateBefore(list, LLast(list));
-  LRemove(list, node);
+          lists[i]->first    = NULL;
+          lists[i]->last     = NULL;
+          lists[i]->count    = 0;
+          lists[i]->sortedby = NULL;
+          lists[i]->version++;
+        }
 
-  node = LCreateAfter(list, LLast(list));
-  LRemove(list, node);
+      if (heads[i])
+        {
+          heap[size++] = i;
+        }
+    }
 
-  node = LCreateAfter(list, LFirst(list));
+  for(i = size / 2; i-- > 0; )
+    {
+      LHeapSiftDown(heads, heap, size, i, NodeCmp);
+    }
 
-  ((test_record_t*)node)->id = 4;
-  ((test_record_t*)node)->value = 4444;
+  list->first = NULL;
 
-  assert(list->count == 4); /* 4 nodes in the list */
-  unittest_show("", list);
+  /*
+   *  Take the smallest head and replace it with its next node.
+   */
+  while(size)
+    {
+      unsigned  top  = heap[0];
+      lnode_t * node = heads[top];
 
-  LRemove(list, LNext(LFirst(list)));
-  assert(list->count == 3);
+      heads[top] = node->next;
 
-  LRemoveLast(list);
-  assert(list->count == 2);
+      if (!heads[top])
+        {
+          heap[0] = heap[--size];
+        }
 
-  LRemoveFirst(list);
-  assert(list->count == 1);
+      if (size > 1)
+        {
+          LHeapSiftDown(heads, heap, size, 0, NodeCmp);
+        }
 
-  LRemoveFirst(list);
-  assert(list->count == 0);
+      node->prev = last;
 
-  LRemoveFirst(list);
-  assert(list->count == 0);
+      if (last)
+        {
+          last->next = node;
+        }
+      else
+        {
+          list->first = node;
+        }
 
-  LDispose(&list);
-  assert(!list);
-  LDispose(&list);
+      last = node;
+    }
 
-  record = (test_record_t*)LCreateFirst(list2);
-  record->id = 101;
+  if (last)
+    {
+      last->next = NULL;
+    }
 
-  record = (test_record_t*)LCreateFirst(list2);
-  record->id = 102;
+  list->last     = last;
+  list->count    = count;
+  list->sortedby = NodeCmp;
 
-  LRemoveFirst(list2);
-  LDispose(&list2);
-  assert(!list2);
-  LDispose(&list2);
+  os_block_dealloc(heads);
 }
 
-/* ------ Testset 2 - moving nodes ------ */
-static void unittest_testset2( void )
-{
-  llist_t * list  = unittest_generate_list( 4,   1, 2, 3, 4);
-  lnode_t * node;
-
-  printf("\nTestset 2 - detach/attach.\n\n");
-
-  node = LFirst(list);
-  LMoveFirst(list, LLast(list));
-  assert(LFirst(list) != node);
-  assert(LPrev(node) == LFirst(list));
 
-  node = LLast(list);
-  LMoveLast(list, LNext(LFirst(list)));
-  assert(LLast(list) != node);
-  assert(LNext(node) == LLast(list));
+/*
+ * Sorting method used is demonstrated below (minrun 4 for the example):
+ *
+ * [ 1, 2A, 5, 6A, 9, 7, 6B, 2B, 3, 8, 6C, 4, 5] <- orginal
+ *
+ * [ 1, 2A, 5, 6A, 9]                  <- ascending run
+ * [ 7, 6B, 2B] + 3   -> [ 2B, 3, 6B, 7]   <- descending run reversed, and
+ * [ 8, 6C, 4]  + 5   -> [ 4, 5, 6C, 8]      extended to minrun by insertion
+ *
+ * [ 2B, 3, 6B, 7] + [ 4, 5, 6C, 8] -> [ 2B, 3, 4, 5, 6B, 6C, 7, 8]
+ * [ 1, 2A, 5, 6A, 9] + [ 2B, ..., 8] -> [ 1, 2A, 2B, 3, 4, 5, 5, 6A, 6B, 6C, 7, 8, 9]
+ *
+ * Runs are kept in stack, and adjacent runs are merged while a run is not
+ * longer than the two next runs together (or than the next run), thus runs
+ * of similar length are merged and stack stays short (log n). When one run
+ * wins LSORT_GALLOP compares in a row, its block of nodes going before the
+ * other run is found by galloping (1, 2, 4.. nodes ahead, then binary) and
+ * linked at once. Runs already in order are concatenated with one compare.
+ *
+ * - equal nodes are taken first from the earlier run, descending runs are
+ *   strictly descending and insertion goes after equal nodes, thus algorithm
+ *   is stable.
+ * - sorted list is one run checked in n compares, and sorted list with k
+ *   nodes appended is sorted in about n + k log k compares.
+ *
+ */
 
-  LMoveFirst(list, LFirst(list));
-  LMoveLast(list, LLast(list));
 
+/*
+ *  Rearrange linked list in reverse order.
+ *
+ */
+void LReverse( llist_t * list )
+{
+  if (LCount(list) > 1)
+    {
+      lnode_t * next = list->first->next;
+      lnode_t * node = list->first->next;
+      list->last     = list->first;
+
+      _LIndexBreak(list);
+
+      while(node)
+        {
+          next = node->next;
+
+          node->next = list->first;
+          list->first->prev = node;
+          list->first = node;
+
+          node = next;
+        }
+
+      list->first->prev = NULL;
+      list->last->next  = NULL;
+    }
+}
+
+
+/*
+ *  Relocate nodes into new memory in list order.
+ *
+ *  All new nodes are allocated before old ones are released, thus they
+ *  come from fresh memory (reserved at once, if memory pool is in use),
+ *  and the following nodes of list are also next to each other in memory.
+ *  If allocation fails, the new nodes are released and list is untouched.
+ *  Old nodes are chained with their next fields until deallocation.
+ */
+lbool_e LCompact( llist_t * list, NodeRelocate_f NodeRelocate )
+{
+  lnode_t * node   = LFirst(list);
+  lnode_t * prev   = NULL;
+  lnode_t * old    = NULL;
+  lnode_t * fresh  = NULL;
+  lnode_t * tail   = NULL;
+  lkeyindex_t * hashindex = (lkeyindex_t*)list->hashindex;
+  NodeCmp_f sortcmp = (list->sortindex ? ((lskiplist_t*)list->sortindex)->NodeCmp : NULL);
+
+  if (list->node_size == 0)
+    {
+      /* only default size nodes can be relocated */
+      return LLIST_NO;
+    }
+
+  if (list->memorypool)
+    {
+      (void)MPoolReserveSpace(list->memorypool, LCount(list), MPOOL_RESERVE_FOR_ONE_USE);
+    }
+
+  /*
+   *  Allocate the new nodes in list order first.
+   */
+  for(; node; node = node->next)
+    {
+      lnode_t * moved = _LAllocate(list);
+
+      if (!moved)
+        {
+          LDealloc(fresh, NULL, list->memorypool);
+          return LLIST_NO;
+        }
+
+      moved->prev = NULL;
+      moved->next = NULL;
+
+      if (tail)
+        {
+          tail->next = moved;
+        }
+      else
+        {
+          fresh = moved;
+        }
+
+      tail = moved;
+    }
+
+  node = LFirst(list);
+
+  /*
+   *  Indices refer to old nodes, so those are rebuilt afterwards.
+   */
+  LSortIndexDisable(list);
+  list->hashindex = NULL;
+  list->version++;
+
+  list->first = NULL;
+
+  while(node)
+    {
+      lnode_t * next  = node->next;
+      lnode_t * moved = fresh;
+
+      fresh = fresh->next;
+      memcpy(moved, node, list->node_size);
+
+      if (NodeRelocate)
+        {
+          NodeRelocate(moved, node);
+        }
+
+      moved->prev = prev;
+      moved->next = NULL;
+
+      if (prev)
+        {
+          prev->next = moved;
+        }
+      else
+        {
+          list->first = moved;
+        }
+
+      prev = moved;
+
+      node->prev = NULL;
+      node->next = old;
+      old  = node;
+      node = next;
+    }
+
+  list->last = prev;
+
+  /*
+   *  Release the old nodes without clearing, as content was moved.
+   */
+  LDealloc(old, NULL, list->memorypool);
+
+  if (hashindex)
+    {
+      LKeyClear(hashindex);
+      LKeyInsertChain(hashindex, LFirst(list));
+      list->hashindex = hashindex;
+    }
+
+  if (sortcmp)
+    {
+      (void)LSortIndexEnable(list, sortcmp);
+    }
+
+  return LLIST_YES;
+}
+
+
+/*
+ *  Offset of the node at given position in image.
+ *
+ */
+#define _LImageOffset( node_size, index )  ((size_t)sizeof(limage_t) + (size_t)(node_size) * (index))
+
+
+/*
+ *  Size of list image.
+ *
+ */
+size_t LImageSize( llist_t * list )
+{
+  if (list->node_size < sizeof(lnode_t))
+    {
+      /* only default size nodes can be written */
+      return 0;
+    }
+
+  if (list->node_size % sizeof(lnode_t*))
+    {
+      /* links of following nodes would not be aligned */
+      return 0;
+    }
+
+  if (LCount(list) > ((size_t)-1 - sizeof(limage_t)) / list->node_size)
+    {
+      /* image would not be addressable */
+      return 0;
+    }
+
+  return _LImageOffset(list->node_size, LCount(list));
+}
+
+
+/*
+ *  Write list image, nodes are copied in list order
+ *  and links are replaced with offsets of neighbours.
+ */
+lbool_e LImageWrite( llist_t * list, void * image, size_t size )
+{
+  limage_t * header = (limage_t*)image;
+  lnode_t *  node;
+  unsigned   index = 0;
+
+  if (LImageSize(list) == 0 || size < LImageSize(list) ||
+      (size_t)image % sizeof(lnode_t*))
+    {
+      return LLIST_NO;
+    }
+
+  header->magic     = LIMAGE_MAGIC;
+  header->link_size = sizeof(lnode_t*);
+  header->node_size = list->node_size;
+  header->count     = LCount(list);
+  header->size      = LImageSize(list);
+
+  LFor(lnode_t*, node, list)
+    {
+      lnode_t * copy = (lnode_t*)((char*)image + _LImageOffset(list->node_size, index));
+
+      memcpy(copy, node, list->node_size);
+
+      copy->prev = (lnode_t*)(index > 0 ? _LImageOffset(list->node_size, index - 1) : 0);
+      copy->next = (lnode_t*)(node->next ? _LImageOffset(list->node_size, index + 1) : 0);
+
+      index++;
+    }
+
+  return LLIST_YES;
+}
+
+
+/*
+ *  Load image into empty list by relinking nodes in place. Each link is
+ *  verified against the layout written before it is replaced, and on
+ *  broken link the nodes relinked so far are restored as offsets.
+ */
+lbool_e LImageLoad( llist_t * list, void * image, size_t size )
+{
+  limage_t * header = (limage_t*)image;
+  lnode_t *  node;
+  unsigned   index;
+
+  if (LCount(list) || size < sizeof(limage_t) || (size_t)image % sizeof(lnode_t*) ||
+      header->magic != LIMAGE_MAGIC || header->link_size != sizeof(lnode_t*) ||
+      header->node_size < sizeof(lnode_t) || header->node_size % sizeof(lnode_t*) ||
+      header->size > size ||
+      header->size < sizeof(limage_t) ||
+      header->count > (header->size - sizeof(limage_t)) / header->node_size ||
+      (list->node_size && list->node_size != header->node_size) ||
+      _LImageOffset(header->node_size, header->count) != header->size)
+    {
+      return LLIST_NO;
+    }
+
+  for(index = 0; index < header->count; index++)
+    {
+      node = (lnode_t*)((char*)image + _LImageOffset(header->node_size, index));
+
+      if ((size_t)node->prev != (index > 0 ? _LImageOffset(header->node_size, index - 1) : 0) ||
+          (size_t)node->next != (index + 1 < header->count ? _LImageOffset(header->node_size, index + 1) : 0))
+        {
+          while(index-- > 0)
+            {
+              node = (lnode_t*)((char*)node - header->node_size);
+              node->prev = (lnode_t*)(index > 0 ? _LImageOffset(header->node_size, index - 1) : 0);
+              node->next = (lnode_t*)_LImageOffset(header->node_size, index + 1);
+            }
+
+          return LLIST_NO;
+        }
+
+      node->prev = (index > 0 ? (lnode_t*)((char*)node - header->node_size) : NULL);
+      node->next = (index + 1 < header->count ? (lnode_t*)((char*)node + header->node_size) : NULL);
+    }
+
+  list->node_size = header->node_size;
+
+  if (header->count)
+    {
+      list->first = (lnode_t*)((char*)image + _LImageOffset(header->node_size, 0));
+      list->last  = (lnode_t*)((char*)image + _LImageOffset(header->node_size, header->count - 1));
+      list->count = header->count;
+
+      _LIndexBreak(list);
+      _LIndexAdd(list, list->first);
+    }
+
+  return LLIST_YES;
+}
+
+
+/*
+ *  Match mask of column values in range, one bit per value of vector.
+ *
+ */
+#if !defined LCOLUMN_SCALAR && defined __AVX2__
+
+#define LCOLUMN_LANES  8
+
+static unsigned LColumnMatch( const int * keys, int low, int high )
+{
+  __m256i values = _mm256_loadu_si256((const __m256i*)keys);
+  __m256i out    = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(low), values),
+                                   _mm256_cmpgt_epi32(values, _mm256_set1_epi32(high)));
+
+  return ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xFF;
+}
+
+#elif !defined LCOLUMN_SCALAR && defined __SSE2__
+
+#define LCOLUMN_LANES  4
+
+static unsigned LColumnMatch( const int * keys, int low, int high )
+{
+  __m128i values = _mm_loadu_si128((const __m128i*)keys);
+  __m128i out    = _mm_or_si128(_mm_cmplt_epi32(values, _mm_set1_epi32(low)),
+                                _mm_cmpgt_epi32(values, _mm_set1_epi32(high)));
+
+  return ~(unsigned)_mm_movemask_ps(_mm_castsi128_ps(out)) & 0xF;
+}
+
+#else
+
+#define LCOLUMN_LANES  1
+
+static unsigned LColumnMatch( const int * keys, int low, int high )
+{
+  return (*keys >= low && *keys <= high ? 1 : 0);
+}
+
+#endif
+
+
+/*
+ *  Amount of bits set, and index of the lowest bit set.
+ *
+ */
+#ifdef __GNUC__
+#define _LBitCount( mask )   ((unsigned)__builtin_popcount(mask))
+#define _LBitFirst( mask )   ((unsigned)__builtin_ctz(mask))
+#else
+static unsigned _LBitCount( unsigned mask )
+{
+  unsigned count = 0;
+
+  for(; mask; mask &= mask - 1)
+    {
+      count++;
+    }
+
+  return count;
+}
+
+static unsigned _LBitFirst( unsigned mask )
+{
+  unsigned first = 0;
+
+  for(; !(mask & 1); mask >>= 1)
+    {
+      first++;
+    }
+
+  return first;
+}
+#endif
+
+
+/*
+ *  Setup column (arrays are allocated at first scan).
+ *
+ */
+void LColumnSetup( lcolumn_t * column, llist_t * list, unsigned offset )
+{
+  (void)memset(column, 0, sizeof(lcolumn_t));
+
+  column->list   = list;
+  column->offset = offset;
+
+  LColumnInvalidate(column);
+}
+
+
+/*
+ *  Release column arrays.
+ *
+ */
+void LColumnDispose( lcolumn_t * column )
+{
+  if (column->keys)
+    {
+      os_block_dealloc(column->keys);
+      os_block_dealloc(column->nodes);
+    }
+
+  column->keys  = NULL;
+  column->nodes = NULL;
+  column->space = 0;
+  column->count = 0;
+
+  LColumnInvalidate(column);
+}
+
+
+/*
+ *  Rebuild column from list, if list has changed.
+ *
+ */
+static void LColumnRefresh( lcolumn_t * column )
+{
+  llist_t * list = column->list;
+  lnode_t * node;
+  unsigned  i = 0;
+
+  if (column->version == list->version)
+    {
+      return;
+    }
+
+  if (column->space < LCount(list))
+    {
+      LColumnDispose(column);
+
+      column->space = LCount(list);
+      column->keys  = (int*)os_block_alloc(column->space * sizeof(int));
+      column->nodes = (lnode_t**)os_block_alloc(column->space * sizeof(lnode_t*));
+    }
+
+  LFor(lnode_t*, node, list)
+    {
+      column->keys[i]  = *(const int*)((const char*)node + column->offset);
+      column->nodes[i] = node;
+      i++;
+    }
+
+  column->count   = i;
+  column->version = list->version;
+}
+
+
+/*
+ *  Count nodes with value in range.
+ *
+ */
+unsigned LColumnCount( lcolumn_t * column, int low, int high )
+{
+  unsigned match = 0;
+  unsigned i = 0;
+
+  LColumnRefresh(column);
+
+  for(; i + LCOLUMN_LANES <= column->count; i += LCOLUMN_LANES)
+    {
+      match += _LBitCount(LColumnMatch(&column->keys[i], low, high));
+    }
+
+  for(; i < column->count; i++)
+    {
+      match += (column->keys[i] >= low && column->keys[i] <= high ? 1 : 0);
+    }
+
+  return match;
+}
+
+
+/*
+ *  Find next node with value in range.
+ *
+ */
+lnode_t * LColumnFind( lcolumn_t * column, int low, int high, unsigned * position )
+{
+  unsigned i = *position;
+  unsigned mask;
+
+  LColumnRefresh(column);
+
+  for(; i + LCOLUMN_LANES <= column->count; i += LCOLUMN_LANES)
+    {
+      mask = LColumnMatch(&column->keys[i], low, high);
+
+      if (mask)
+        {
+          i += _LBitFirst(mask);
+          *position = i + 1;
+          return column->nodes[i];
+        }
+    }
+
+  for(; i < column->count; i++)
+    {
+      if (column->keys[i] >= low && column->keys[i] <= high)
+        {
+          *position = i + 1;
+          return column->nodes[i];
+        }
+    }
+
+  *position = column->count;
+  return NULL;
+}
+
+
+/*
+ * Internal typacast for expanded nodes.
+ *   
+ */
+typedef struct 
+  { 
+    LLIST_NODE
+    unsigned offset;
+  } lnode_offset_t;
+
+
+/*
+ *  Calculate new size and offset to add lnode_t fields at the end.
+ *
+ */
+unsigned LExpandedSize( unsigned * size )
+{
+  /*
+   *  Correct alingment by 4 (just in case, since sizeof is
+   *  always aligned by 4 in C) and increase the node size.
+   */
+  unsigned offset = *size;
+
+  if ((*size % 4) != 0)
+    {
+      offset = *size + 4 - (*size % 4);
+    }
+
+  *size = offset +  sizeof(lnode_offset_t);
+
+  return offset;
+}
+
+
+/*
+ *  Typecast object to lnode with given offset.
+ *
+ */
+lnode_t * LCastNode( void * object, unsigned offset )
+{
+  lnode_offset_t * offset_node =
+      (lnode_offset_t*)&(*(char**)((char*)(object) + offset));
+
+  offset_node->next   = NULL;
+  offset_node->prev   = NULL;
+  offset_node->offset = offset;
+
+  return (lnode_t*)offset_node;
+}
+
+
+/*
+ *  Typecast node back to object by stored offset.
+ *
+ */
+void * LCastObject( lnode_t* node )
+{
+  return &(*(char**)((char*)(node) - ((lnode_offset_t*)node)->offset));
+}
+
+
+/*
+ *  Deallocate Expanded.
+ *
+ */
+lnode_t * LExpandedDealloc( lnode_t * node )
+{
+  void * object = LCastObject( node );
+  os_block_dealloc(object);
+  return NULL;
+}
+
+
+/* --------------------------------------------------------------- */
+
+#if defined LLIST_UNITTEST || defined MPOOL_UNITTEST || defined LLIST_OS_STUBS
+
+/*
+ *  gcc -fprofile-arcs -ftest-coverage -DLLIST_UNITTEST -o llist.exe llist.c mpool.c -lpthread
+ *
+ *  Test coverage (100%):
+ *  ./llist.exe
+ *  gcov llist.c
+ *
+ *  Memory leaks (0 bytes):
+ *  valgrind ./llist.exe
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <time.h>
+
+/* set by tests for no wait allocations to fail (also those of mpool.c and modules) */
+unsigned os_block_alloc_occupied = LLIST_NO;
+
+static void * os_block_alloc(unsigned size)
+{
+  return memcpy(malloc(size), "deadbeef", 8);
+}
+
+static void * os_block_alloc_and_clear(unsigned size)
+{
+  return memset(malloc(size), 0, size);
+}
+
+static void * os_block_alloc_no_wait(unsigned size)
+{
+  return (os_block_alloc_occupied ? NULL : os_block_alloc(size));
+}
+
+static void os_block_dealloc(void* ptr)
+{
+  free(ptr);
+}
+
+#endif /* LLIST_UNITTEST || MPOOL_UNITTEST || LLIST_OS_STUBS */
+
+#if defined LLIST_UNITTEST
+
+#include <pthread.h>
+
+/*
+ *  Test structure
+ *
+ */
+typedef struct
+{
+  LLIST_NODE
+  int    id;
+  int    value;
+  char * string;
+} test_record_t;
+
+
+static void unittest_show(char * name, llist_t * list)
+{
+  if (list)
+    {
+      test_record_t * record = NULL;
+      lnode_t * node = LFirst(list);
+      lnode_t * prev = NULL;
+      unsigned count = 0;
+
+      printf("%s List, with %d nodes:\n", name, LCount(list));
+
+      if (!node) printf("no nodes\n"); else
+        {
+          assert(!LPrev(LFirst(list)));     /* 1. verify head of list */
+          assert(!LNext(LLast(list)));      /* 2. verify tail of list */
+
+          while(node)
+            {
+              assert(LPrev(node) == prev);  /* 3. verify backward linking ... */
+              prev   = node;
+              record = (test_record_t*)node;
+              node   = LNext(node);         /* 4. ... while using forward linking */
+              count++;
+
+              printf("element id=%d, value=%d\n", record->id, record->value);
+            }
+        }
+      assert(LCount(list) == count);        /* 5. verify list count */
+    }
+  else
+    {
+      printf("no list\n");
+    }
+
+  printf("-------------\n");
+}
+
+static signed int unittest_compare(const lnode_t* node1, const lnode_t* node2)
+{
+  return (signed int)(((test_record_t*)node1)->value - ((test_record_t*)node2)->value);
+}
+
+static unsigned unittest_hash(const lnode_t* node)
+{
+  return (unsigned)((test_record_t*)node)->value * 2654435761u;
+}
+
+static lbool_e unittest_filter(const lnode_t* node, unsigned user_data)
+{
+  return (((test_record_t*)node)->value > (int)user_data ? LLIST_YES : LLIST_NO);
+}
+
+static lbool_e unittest_operate(const lnode_t* node, unsigned user_data)
+{
+  printf("Operating node %d by increasing value %d by %d\n", 
+    ((test_record_t*)node)->id, ((test_record_t*)node)->value, user_data);
+
+  ((test_record_t*)node)->value += user_data;
+  return LLIST_YES; /* meaningless */
+}
+
+static lnode_t* unittest_clone(const lnode_t* node, unsigned user_data)
+{
+  test_record_t* newrecord = (test_record_t*)os_block_alloc(sizeof(test_record_t));
+  newrecord->id    = ((test_record_t*)node)->id;
+  newrecord->value = ((test_record_t*)node)->value + user_data;
+  return (lnode_t*)newrecord;
+}
+
+static lnode_t * unittest_free(lnode_t* node)
+{
+  printf("free any allocated data node %d might possess.\n",
+      ((test_record_t*)node)->id);
+  return node;
+}
+
+static llist_t * unittest_generate_list( unsigned count, ... )
+{
+  llist_t * list = LInit(sizeof(test_record_t), NULL, NULL);
+  test_record_t * record;
+  va_list valuelist;
+  unsigned i = 0;
+
+  va_start(valuelist, count);
+
+  while(i < count)
+    {
+      record = (test_record_t*)LCreateLast(list);
+      record->id = ++i;
+      record->value = va_arg(valuelist, int);
+    }
+
+  va_end(valuelist);
+
+  return list;
+}
+
+static void unittest_dispose_all( llist_t * list, ... )
+{
+  va_list lists;
+  va_start(lists, list);
+
+  while(list != NULL) 
+    {
+      LDispose(&list);
+      list = va_arg(lists, llist_t *);
+    }
+
+  va_end(lists);
+}
+
+/* ------ Testset 1 - create nodes ------ */
+
+/* Output:
+ *
+ *  List, with 4 nodes:
+ *  element id = 3, value = 333
+ *  element id = 4, value = 4444
+ *  element id = 1, value = 1
+ *  element id = 2, value = 22
+ *
+ */
+static void unittest_testset1( void )
+{
+  llist_t * list  = LInit( sizeof(test_record_t), NULL, NULL );
+  llist_t * list2 = LInit( sizeof(test_record_t), unittest_free, NULL );
+  test_record_t * record = NULL;
+  lnode_t * node;
+
+  printf("\nTestset 1 - create nodes.\n\n");
+
+  record = (test_record_t*)LCreateFirst(list);
+  assert(list->count == 1);
+  assert(!list->last->next);
+  assert(!list->first->prev);
+  LRemove(list, (lnode_t*)record);
+  assert(list->count == 0);
+
+  record = (test_record_t*)LCreateLast(list);
+  record->id = 1;
+  record->value = 1;
+
+  record = (test_record_t*)LCreateLast(list);
+  record->id = 2;
+  record->value = 22;
+
+  record = (test_record_t*)LCreateFirst(list);
+  record->id = 3;
+  record->value = 333;
+
+  node = LCreateBefore(list, LFirst(list));
+  LRemove(list, node);
+
+  node = LCreateBefore(list, LLast(list));
+  LRemove(list, node);
+
+  node = LCreateAfter(list, LLast(list));
+  LRemove(list, node);
+
+  node = LCreateAfter(list, LFirst(list));
+
+  ((test_record_t*)node)->id = 4;
+  ((test_record_t*)node)->value = 4444;
+
+  assert(list->count == 4); /* 4 nodes in the list */
+  unittest_show("", list);
+
+  LRemove(list, LNext(LFirst(list)));
+  assert(list->count == 3);
+
+  LRemoveLast(list);
+  assert(list->count == 2);
+
+  LRemoveFirst(list);
+  assert(list->count == 1);
+
+  LRemoveFirst(list);
+  assert(list->count == 0);
+
+  LRemoveFirst(list);
+  assert(list->count == 0);
+
+  LDispose(&list);
+  assert(!list);
+  LDispose(&list);
+
+  record = (test_record_t*)LCreateFirst(list2);
+  record->id = 101;
+
+  record = (test_record_t*)LCreateFirst(list2);
+  record->id = 102;
+
+  LRemoveFirst(list2);
+  LDispose(&list2);
+  assert(!list2);
+  LDispose(&list2);
+}
+
+/* ------ Testset 2 - moving nodes ------ */
+static void unittest_testset2( void )
+{
+  llist_t * list  = unittest_generate_list( 4,   1, 2, 3, 4);
+  lnode_t * node;
+
+  printf("\nTestset 2 - detach/attach.\n\n");
+
+  node = LFirst(list);
+  LMoveFirst(list, LLast(list));
+  assert(LFirst(list) != node);
+  assert(LPrev(node) == LFirst(list));
+
+  node = LLast(list);
+  LMoveLast(list, LNext(LFirst(list)));
+  assert(LLast(list) != node);
+  assert(LNext(node) == LLast(list));
+
+  LMoveFirst(list, LFirst(list));
+  LMoveLast(list, LLast(list));
+
+  node = LNext(LFirst(list));
+  assert(LPrev(node) == LFirst(list));
+  LMoveAfter(list, LFirst(list), LNext(LFirst(list)));
+  assert(LPrev(node) != LFirst(list));
+
+  node = LPrev(LLast(list));
+  assert(LNext(node) == LLast(list));
+  LMoveBefore(list, LLast(list), LPrev(LLast(list)));
+  assert(LNext(node) != LLast(list));
+
+  LMoveAfter(list, LFirst(list), LLast(list));
+  LMoveBefore(list, LLast(list), LFirst(list));
+
+  LMoveAfter(list, LFirst(list), LFirst(list));
+  LMoveBefore(list, LLast(list), LLast(list));
+
+  unittest_show("reordered", list);
+  unittest_dispose_all(list, NULL);
+}
+
+
+/* ------ Testset 3 - detach/attach ------ */
+static void unittest_testset3( void )
+{
+  llist_t * list;
+  lnode_t * node;
+  lnode_t * node1;
+  lnode_t * node2;
+
+  printf("\nTestset 3 - detach/attach.\n\n");
+
+  list  = unittest_generate_list( 4,   22, 4444, 1, 333);
+  node1 = LDetachFirst(list);
+  node2 = LDetachLast(list);
+
+  assert(node1);
+  assert(node2);
+  assert(list->count == 2); /* 2 nodes in the list */
+
+  LAttachFirst(list, node2);
+  LAttachLast(list, node1);
+
+  assert(list->count == 4); /* 4 node in the list */
+  unittest_show("", list);
+
+  node1 = LFirst(list);
+  LDetachMany(list, node1, 3, LLOOP_FORWARD);
+  assert(LDetachCount(node1, LLOOP_FORWARD) == 3);
+
+  assert(list->count == 1); /* 1 node in the list */
+  unittest_show("", list);
+
+  node2 = LFirst(list);
+  LDetachMany(list, node2, 0, LLOOP_FORWARD); /* detach rest */
+  assert(LDetachCount(node2, LLOOP_FORWARD) == 1);
+
+  LAttachLast(list, node2);
+  node2 = LDetachFirst(list);
+  LAttachLast(list, node2);
+  node2 = LDetachLast(list);
+  LAttachLast(list, node2);
+
+  LAttachLast(list, node1);
+  assert(list->count == 4); /* 4 nodes in the list */
+  unittest_show("", list);
+
+  node = LNext(LFirst(list));
+  LDetachMany(list, node, 2, LLOOP_FORWARD);
+  assert(LNext(LFirst(list)) == LLast(list));
+  assert(LPrev(LLast(list)) == LFirst(list));
+  LAttachAfter(list, node, LFirst(list));
+
+  node = LNext(LFirst(list));
+  LDetachMany(list, LNext(node), 2, LLOOP_BACKWARD);
+  LAttachBefore(list, node, LLast(list));
+
+  node = LDetachAll(list);
+  assert(LCount(list) == 0);
+  assert(LDetachCount(node, LLOOP_FORWARD) == 4);
+  assert(LDetachCount(LNext(LNext(node)), LLOOP_BACKWARD) == 3);
+  LAttachBefore(list, node, LFirst(list));
+  assert(LCount(list) == 4); /* 4 nodes in the list */
+
+  unittest_show("", list);
+  unittest_dispose_all(list, NULL);
+}
+
+
+/* ------ Testset 4 - detach/attach ------ */
+static void unittest_testset4( void )
+{
+  test_record_t * record = NULL;
+  llist_t * list  = unittest_generate_list( 4,   22, 4444, 1, 333);
+  lnode_t * node;
+
+  printf("\nTestset 4 - alloc/dealloc.\n\n");
+
+  unittest_show("", list);
+
+  node = LFirst(list);
+  LDetachMany(list, node, 2, LLOOP_FORWARD);
+  LDealloc(LNext(node), NULL, NULL);
+
+  unittest_show("", list);
+
+  record = (test_record_t*)LAlloc( sizeof(test_record_t), LLIST_YES);
+  record->id = 2;
+  record->value = 22;
+
+  LAttachFirst(list, (lnode_t*)record);
+
+  record = (test_record_t*)LAlloc( sizeof(test_record_t), LLIST_NO);
+  record->id = 3;
+  record->value = 333;
+
+  LAttachFirst(list, (lnode_t*)record);
+
+  unittest_show("", list);
+  unittest_dispose_all(list, NULL);
+}
+
+
+/* ------ Testset 5 - indecis ------ */
+static void unittest_testset5( void )
+{
+  llist_t * list  = unittest_generate_list( 4,   22, 4444, 1, 333);
+  lnode_t * node;
+  int index;
+
+  printf("\nTestset 5 - indecis.\n\n");
+
+  node = LGetNode(list, 0);
+  assert(node == LFirst(list));
+
+  node = LGetNode(list, -100);
+  assert(node);
+
+  node = LGetNode(list, LCount(list)-2);
+  assert(node);
+  assert(((test_record_t*)node)->id == 3);
+
+  index = LSetIndex(list, NULL,  0);
+  assert(index == -1);
+
+  node = LGetNode(list, -100);
+  assert(node);
+
+  index = LSetIndex(list, node, 100);
+  assert(index == LLastIndex(list));
+
+  (void)LSetIndex(list, node, 1);
+  index = LGetIndex(list, node);
+  assert(index == 1);
+
+  unittest_show("", list);
+  unittest_dispose_all(list, NULL);
+}
+
+
+/* ------ Testset 6 - split/join ------ */
+static void unittest_testset6( void )
+{
+  llist_t * list   = unittest_generate_list( 4,   1, 22, 333, 4444);
+  llist_t * c1list = NULL;
+
+  printf("\nTestset 6 - split/join.\n\n");
+
+  c1list = LSplit(list, LNext(LFirst(list)));
+  unittest_show("orginal", list);
+  unittest_show("splitted", c1list);
+
+  LJoin(list, &c1list);
+  unittest_show("orginal", list);
+  unittest_show("splitted", c1list);
+
+  c1list = LSplit(list, LFirst(list));
+  unittest_show("orginal", list);
+  unittest_show("splitted", c1list);
+
+  LJoin(list, &c1list);
+  unittest_show("orginal", list);
+  unittest_show("splitted", c1list);
+
+  assert(list->count == 4); /* 4 nodes in the list */
+  unittest_dispose_all(list, c1list, NULL);
+}
+
+
+/* ------ Testset 7 - swapping inside ------ */
+static void unittest_testset7( void )
+{
+  llist_t * list = unittest_generate_list( 4,   1, 22, 333, 4444);
+
+  printf("\nTestset 7 - swapping inside.\n\n");
+
+  LSwapInside(list, LFirst(list), LFirst(list));
+
+  unittest_show("", list);
+
+  LSwapInside(list, LNext(LFirst(list)), LLast(list));
+  LSwapInside(list, LPrev(LLast(list)),  LFirst(list));
+
+  LSwapInside(list, LFirst(list), LLast(list));
+
+  LSwapInside(list, LLast(list),  LNext(LFirst(list)));
+  LSwapInside(list, LFirst(list), LPrev(LLast(list)));
+
+  unittest_show("", list);
+
+  LSwapInside(list, LNext(LFirst(list)), LFirst(list));
+  LSwapInside(list, LPrev(LLast(list)),  LLast(list));
+
+  LSwapInside(list, LFirst(list), LNext(LFirst(list)));
+
+  LSwapInside(list, LFirst(list), LNext(LFirst(list)));
+  LSwapInside(list, LLast(list),  LPrev(LLast(list)));
+
+  unittest_show("", list);
+  unittest_dispose_all(list, NULL);
+}
+
+
+/* ------ Testset 8 - filtering ------ */
+static void unittest_testset8( void )
+{
+  llist_t * list    = unittest_generate_list( 4,   1, 22, 333, 4444);
+  llist_t * list2   = unittest_generate_list( 11,  10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110);
+  llist_t * unique1 = unittest_generate_list( 7,   2, 2, 2, 4, 5, 5, 5);
+  llist_t * unique2 = unittest_generate_list( 7,   2, 2, 2, 4, 5, 5, 5);
+  llist_t * unique3 = unittest_generate_list( 7,   2, 2, 2, 4, 5, 5, 5);
+  llist_t * unique4 = unittest_generate_list( 7,   2, 2, 2, 4, 5, 5, 5);
+  llist_t * c1list  = NULL;
+  llist_t * c2list  = NULL;
+
+  printf("\nTestset 8 - clone.\n\n");
+
+  LFilterClone(list, &c1list, NULL, 0);
+  unittest_show("orginal", list);
+  unittest_show("clone1", c1list);
+
+  LFilterClone(list, &c2list, unittest_clone, 10000);
+  unittest_show("clone2", c2list);
+
+  LRemoveAll(c2list);
+  LFilterClone(list, &c2list, unittest_clone, 10000);
+  unittest_show("clone2", c2list);
+
+  LDispose(&c2list);
+  LFilterMove(list, &c2list, unittest_filter, 22);
+  unittest_show("filtered", c2list);
+
+  LRemoveAll(c2list);
+  LFilterMove(list, &c2list, unittest_filter, 22);
+  unittest_show("filtered", c2list);
+
+  unittest_show("filtered(count)", list2);
+  assert(LFilterCount(list2, unittest_filter, 70) == 4);
+  
+  assert(LFilterOperate(list2, unittest_filter, 70, unittest_operate, 1000) == 4);
+  unittest_show("filtered(operate)", list2);
+
+  assert(LFilterRemove(list2, unittest_filter, 20) == 9);
+  unittest_show("filtered(remove)", list2);
+
+  unittest_show("duplicates", unique1);
+  LUnique(unique1, unittest_compare, LLOOP_FORWARD);
+  unittest_show("duplicates", unique1);
+  assert( ((test_record_t*)LFirst(unique1))->id == 1 );
+  assert( ((test_record_t*)LLast(unique1))->id  == 5 );
+
+  unittest_show("duplicates", unique2);
+  LUnique(unique2, unittest_compare, LLOOP_BACKWARD);
+  unittest_show("duplicates", unique2);
+  assert( ((test_record_t*)LFirst(unique2))->id == 3 );
+  assert( ((test_record_t*)LLast(unique2))->id  == 7 );
+
+  LUniqueHashed(unique3, unittest_hash, unittest_compare, LLOOP_FORWARD);
+  unittest_show("duplicates", unique3);
+  assert( LCount(unique3) == 3 );
+  assert( ((test_record_t*)LFirst(unique3))->id == 1 );
+  assert( ((test_record_t*)LLast(unique3))->id  == 5 );
+
+  LUniqueHashed(unique4, unittest_hash, unittest_compare, LLOOP_BACKWARD);
+  unittest_show("duplicates", unique4);
+  assert( LCount(unique4) == 3 );
+  assert( ((test_record_t*)LFirst(unique4))->id == 3 );
+  assert( ((test_record_t*)LLast(unique4))->id  == 7 );
+
+  /* hash table bigger than pool block is taken from OS */
+  {
+    void *    pool   = MPoolInit(sizeof(test_record_t), MPOOL_WAIT, MPOOL_ZERO_MEMSET);
+    llist_t * pooled = LInit(sizeof(test_record_t), NULL, pool);
+    int       i;
+
+    for(i = 0; i < 100; i++)
+      {
+        ((test_record_t*)LCreateLast(pooled))->value = i % 10;
+      }
+
+    LUniqueHashed(pooled, unittest_hash, unittest_compare, LLOOP_FORWARD);
+    assert( LCount(pooled) == 10 );
+
+    LDispose(&pooled);
+    MPoolDispose(&pool);
+  }
+
+  unittest_dispose_all(list, list2, unique1, unique2, unique3, unique4, c1list, c2list, NULL);
+}
+
+
+/* ------ Testset 9 - swapping between------ */
+static void unittest_testset9( void )
+{
+  llist_t * c1list = unittest_generate_list( 4,   1, 22, 333, 4444);
+  llist_t * c2list = unittest_generate_list( 4,   1, 22, 333, 4444);
+
+  printf("\nTestset 9 - swapping between.\n\n");
+
+  LSwapBetween(c1list, LFirst(c1list), c1list, LFirst(c1list));
+
+  unittest_show("clone1", c1list);
+  unittest_show("clone2", c2list);
+
+  LSwapBetween(c1list, LFirst(c1list), c2list, LFirst(c2list));
+  LSwapBetween(c1list, LLast(c1list), c2list, LLast(c2list));
+
+  LSwapBetween(c1list, LNext(LFirst(c1list)), c2list, LPrev(LLast(c2list)));
+
+  unittest_show("clone1", c1list);
+  unittest_show("clone2", c2list);
+
+  LSwapBetween(c1list, LFirst(c1list), c2list, LLast(c2list));
+  LSwapBetween(c1list, LLast(c1list), c2list, LFirst(c2list));
+
+  LSwapBetween(c1list, LNext(LFirst(c1list)), c2list, LPrev(LLast(c2list)));
+
+  unittest_show("clone1", c1list);
+  unittest_show("clone2", c2list);
+
+  LSwapAll(c1list, c2list);
+
+  unittest_show("clone1", c1list);
+  unittest_show("clone2", c2list);
+
+  LSwapAll(c1list, c2list);
+
+  unittest_dispose_all( c1list, c2list, NULL);
+}
+
+
+/* ------ Testset 10 - compare ------ */
+static void unittest_testset10( void )
+{
+  llist_t * orginal   = unittest_generate_list( 6,   1, 2, 3, 4, 5, 6);
+  llist_t * inorder   = unittest_generate_list( 6,   1, 2, 3, 4, 5, 6);
+  llist_t * reverse   = unittest_generate_list( 6,   6, 5, 4, 3, 2, 1);
+  llist_t * nonorder  = unittest_generate_list( 6,   4, 5, 1, 2, 3, 6);
+  llist_t * subset    = unittest_generate_list( 4,   2, 3, 4, 5);
+  llist_t * revsubset = unittest_generate_list( 4,   5, 4, 3, 2);
+  llist_t * included  = unittest_generate_list( 4,   1, 3, 4, 6);
+  llist_t * covered   = unittest_generate_list( 6,   1, 1, 6, 5, 4, 5);
+  llist_t * partial   = unittest_generate_list( 2,   2,  99 );
+  llist_t * nothing   = unittest_generate_list( 2,   88, 99 );
+  llist_t * nothing2  = unittest_generate_list( 6,   11, 22, 33, 44, 55, 66 );
+  lnode_t * node;
+
+  printf("\nTestset 10 - compare.\n\n");
+
+  unittest_show("orginal", orginal);
+
+  node = LFirst(orginal);
+  assert(LContains(orginal, node));
+  assert(!LContains(nothing, node));
+
+  assert(LCompare(inorder,   orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_INORDER);
+  assert(LCompare(reverse,   orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_REVERSE);
+  assert(LCompare(nonorder,  orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_NONORDER);
+  assert(LCompare(subset,    orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_SUBSET);
+  assert(LCompare(orginal,   subset,  unittest_compare, LLISTCMP_NO_LIMITS) != LLISTCMP_MATCH_SUBSET);
+  assert(LCompare(revsubset, orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_REVSUBSET);
+  assert(LCompare(included,  orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_INCLUDED);
+  assert(LCompare(covered,   orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_COVERED);
+  assert(LCompare(orginal,   covered, unittest_compare, LLISTCMP_NO_LIMITS) != LLISTCMP_MATCH_COVERED);
+  assert(LCompare(partial,   orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_PARTIAL);
+  assert(LCompare(nothing,   orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_NOTHING);
+  assert(LCompare(nothing2,  orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_NOTHING);
+
+  assert(LCompareHashed(inorder,  orginal, unittest_compare, unittest_hash, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_INORDER);
+  assert(LCompareHashed(nonorder, orginal, unittest_compare, unittest_hash, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_NONORDER);
+  assert(LCompareHashed(included, orginal, unittest_compare, unittest_hash, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_INCLUDED);
+  assert(LCompareHashed(covered,  orginal, unittest_compare, unittest_hash, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_COVERED);
+  assert(LCompareHashed(orginal,  covered, unittest_compare, unittest_hash, LLISTCMP_NO_LIMITS) != LLISTCMP_MATCH_COVERED);
+  assert(LCompareHashed(partial,  orginal, unittest_compare, unittest_hash, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_PARTIAL);
+  assert(LCompareHashed(nothing2, orginal, unittest_compare, unittest_hash, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_NOTHING);
+
+  /* limit mask skips other compare options */
+  assert(LCompareHashed(inorder,  orginal, unittest_compare, unittest_hash,
+                        LLISTCMP_MATCH_NONORDER) == LLISTCMP_MATCH_NONORDER);
+  assert(LCompare(subset,  orginal, unittest_compare, LLISTCMP_MATCH_INCLUDED) == LLISTCMP_MATCH_INCLUDED);
+  assert(LCompare(partial, orginal, unittest_compare, LLISTCMP_MATCH_COVERED) == LLISTCMP_MATCH_NOTHING);
+
+  LRemoveAll(orginal);
+  assert(LCompare(nothing,  orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_NOTHING);
+  LRemoveAll(nothing);
+  assert(LCompare(nothing,  orginal, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_NOTHING);
+
+  unittest_dispose_all( orginal, reverse, inorder, nonorder, subset,
+      revsubset, included, covered, partial, nothing, nothing2, NULL);
+}
+
+
+/* ------ Testset 11 - finding ------ */
+static void unittest_testset11( void )
+{
+  const char* string = "unittest";
+  llist_t * list   = unittest_generate_list( 6,   1, 2, 3, 4, 5, 1);
+  llist_t * list2  = unittest_generate_list( 4,   3, 4, 5, 6);
+  lnode_t * node;
+
+  printf("\nTestset 11 - finding.\n\n");
+
+  node = LFindPair( LNext(LFirst(list)), unittest_compare, LLast(list), LLOOP_FORWARD);
+  assert(node != NULL);
+  assert(((test_record_t*)node)->id == 6);
+
+  node = LFindPair( LNext(LFirst(list)), unittest_compare, LLast(list), LLOOP_BACKWARD);
+  assert(node != NULL);
+  assert(((test_record_t*)node)->id == 1);
+
+  node = LFindPair( LFirst(list), unittest_compare, LFirst(list2), LLOOP_FORWARD);
+  assert(node != NULL);
+  node = LFindPair( LFirst(list), unittest_compare, LLast(list2),  LLOOP_FORWARD);
+  assert(node == NULL);
+
+  node = LFindNode(LLast(list), unittest_filter, 9999, LLOOP_BACKWARD);
+  assert(node == NULL);
+
+  node = LFindNode(LFirst(list), unittest_filter, 1, LLOOP_FORWARD);
+  assert(node == LNext(LFirst(list)));
+
+  node = LFindValue( LFirst(list), offsetof(test_record_t, id), -3, sizeof(int), LLOOP_FORWARD);
+  assert(node == NULL);
+
+  node = LFindValue( LFirst(list), offsetof(test_record_t, id), 3, sizeof(int), LLOOP_FORWARD);
+  assert(((test_record_t*)node)->id == 3);
+
+  /* modify node 3 data field */
+  ((test_record_t*)node)->string = (char*)string;
+
+  node = LFindData( LFirst(list), offsetof(test_record_t, string), (char*)string, strlen(string)+1, LLOOP_FORWARD);
+  assert(((test_record_t*)node)->id == 3);
+
+  node = LFindData( LFirst(list), offsetof(test_record_t, string), "nonsense", 0, LLOOP_FORWARD);
+  assert(node == NULL);
+
+  node = LFindData( LFirst(list), offsetof(test_record_t, string), "unittest", 0, LLOOP_FORWARD);
+  assert(((test_record_t*)node)->id == 3);
+
+  node = LFindData( node, offsetof(test_record_t, string), NULL, 0, LLOOP_BACKWARD);
+  assert(((test_record_t*)node)->id != 3);
+
+  node = LFindData( LFirst(list), offsetof(test_record_t, string), NULL, 0, LLOOP_FORWARD);
+  assert(LIsFirst(node));
+  assert(!LIsLast(node));
+
+  LRemoveAll(list2);
+  assert(LIsFirst(list2->first)); /* NULL */
+  assert(LIsLast(list2->first));  /* NULL */
+
+  unittest_dispose_all(list, list2, NULL);
+}
+
+/* ------ Testset 12 - sorting ------ */
+static void unittest_testset12( void )
+{
+  test_record_t * record1 = NULL;
+  test_record_t * record2 = NULL;
+  test_record_t * record3 = NULL;
+  llist_t * list = unittest_generate_list( 4, 1, 22, 333, 4444);
+
+  printf("\nTestset 12 - sorting.\n\n");
+
+  unittest_show("unsorted", list);
+  LSort(list, unittest_compare);
+
+  unittest_show("sorted", list);
+  LSort(list, unittest_compare);
+
+  record1 = (test_record_t*)LCreateBefore(list, LLast(list));
+  record1->id = 5;
+  record1->value = 1;
+
+  record1 = (test_record_t*)LCreateAfter(list, LFirst(list));
+  record1->id = 6;
+  record1->value = 4444;
+
+  record1 = (test_record_t*)LCreateAfter(list, LFirst(list));
+  record1->id = 7;
+  record1->value = 333;
+  assert(list->count == 7);
+
+  assert(LVerify(list, unittest_compare) == LLIST_NO);
+  unittest_show("unsorted", list);
+
+  LSort(list, unittest_compare);
+  unittest_show("sorted", list);
+
+  LShuffle(list, NULL);
+  unittest_show("unsorted", list);
+
+  {
+    llist_t * shuffle1 = unittest_generate_list( 8,   1, 2, 3, 4, 5, 6, 7, 8);
+    llist_t * shuffle2 = unittest_generate_list( 8,   1, 2, 3, 4, 5, 6, 7, 8);
+
+    LShuffleSeed(12345);
+    LShuffle(shuffle1, NULL);
+    LShuffleSeed(12345);
+    LShuffle(shuffle2, NULL);
+    unittest_show("shuffled", shuffle1);
+    assert(LCompare(shuffle1, shuffle2, unittest_compare, LLISTCMP_NO_LIMITS) == LLISTCMP_MATCH_INORDER);
+
+    LShuffle(shuffle2, rand);
+    unittest_show("shuffled", shuffle2);
+    assert(LCount(shuffle2) == 8);
+
+    unittest_dispose_all(shuffle1, shuffle2, NULL);
+  }
+
+  LReverse(list);
+  LSort(list, unittest_compare);
+  unittest_show("sorted", list);
+
+  LVerify(list, unittest_compare);
+
+  record1 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
+  record1->id = 801;
+  record1->value = 22;
+  LAttachSorted(list, (lnode_t*)record1, unittest_compare, LLOOP_FORWARD);
+  assert(list->count == 8);
+
+  record2 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
+  record2->id = 802;
+  record2->value = 22;
+  LAttachSorted(list, (lnode_t*)record2, unittest_compare, LLOOP_FORWARD);
+  assert(LPrev(record1) == (lnode_t*)record2);
+
+  record3 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
+  record3->id = 803;
+  record3->value = 22;
+  LAttachSorted(list, (lnode_t*)record3, unittest_compare, LLOOP_BACKWARD);
+  assert(LPrev(LPrev(record3)) == (lnode_t*)record1);
+
+  record1 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
+  record1->id = 804;
+  record1->value = 0;
+  LAttachSorted(list, (lnode_t*)record1, unittest_compare, LLOOP_BACKWARD);
+  assert(LFirst(list) == (lnode_t*)record1);
+
+  record1 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
+  record1->id = 805;
+  record1->value = 9999;
+  LAttachSorted(list, (lnode_t*)record1, unittest_compare, LLOOP_FORWARD);
+  assert(LLast(list) == (lnode_t*)record1);
+
+  LVerify(list, unittest_compare);
+  unittest_show("sorted", list);
+
+  LReverse(list);
+  LVerify(list, unittest_compare);
+
+  unittest_dispose_all(list, NULL);
+}
+
+
+/* ------ Testset 13 - expanded nodes ------ */
+static void unittest_testset13( void )
+{
+  typedef struct
+    {
+      int id;
+      int value;
+      char padding;
+    } any_struct_t;
+
+  llist_t * list = LInit(0, LExpandedDealloc, NULL);
+  any_struct_t * object = NULL;
+  lnode_t * node = NULL;
+  unsigned size;
+  unsigned offset;
+
+  printf("\nTestset 12 - expanded size.\n\n");
+
+  size   = sizeof(any_struct_t) + /* test */ 1;
+  offset = LExpandedSize( &size );
+  assert( size != sizeof(any_struct_t) );
+
+  object = (any_struct_t*)os_block_alloc_and_clear( size );
+  object->id    = 1;
+  object->value = 10;
+  LAttachLast(list, LCastNode( (void*)object, offset ));
+
+  object = (any_struct_t*)os_block_alloc_and_clear( size + 1);
+  object->id    = 2;
+  object->value = 20;
+  LAttachLast(list, LCastNode( (void*)object, offset ));
+
+  object = (any_struct_t*)os_block_alloc_and_clear( size + 2);
+  object->id    = 3;
+  object->value = 30;
+  LAttachLast(list, LCastNode( (void*)object, offset ));
+
+  object = (any_struct_t*)os_block_alloc_and_clear( size + 3);
+  object->id    = 4;
+  object->value = 40;
+  LAttachLast(list, LCastNode( (void*)object, offset ));
+
+  assert(LCount(list) == 4);
+  printf("List with %d expanded nodes.\n", LCount(list)); 
+  node = LFirst(list);
+
+  while(node)
+    {
+      object = LCastObject(node);
+      printf("object id %d value = %d\n", object->id, object->value);
+      node = LNext(node);
+    }
+
+  assert(LCount(list) == 4);
+  LRemoveAll(list);
+  assert(LCount(list) == 0);
+
+  unittest_dispose_all(list, NULL);
+}
+
+
+/* ------ Testset 14 - sorted index ------ */
+static void unittest_testset14( void )
+{
+  llist_t * list = unittest_generate_list( 5,   1, 3, 3, 7, 9);
+  test_record_t * record = NULL;
+  test_record_t   match;
+  lnode_t * node;
+  int i;
+
+  printf("\nTestset 14 - sorted index.\n\n");
+
+  assert(LSortIndexEnable(list, unittest_compare) == LLIST_YES);
+
+  /* equal nodes attached as in LAttachSorted without index */
+  record = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
+  record->id = 6;
+  record->value = 3;
+  LAttachSorted(list, (lnode_t*)record, unittest_compare, LLOOP_FORWARD);
+  assert(((test_record_t*)LNext(LFirst(list)))->id == 6);
+
+  record = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
+  record->id = 7;
+  record->value = 3;
+  LAttachSorted(list, (lnode_t*)record, unittest_compare, LLOOP_BACKWARD);
+  assert(((test_record_t*)LPrev(LPrev(LLast(list))))->id == 7);
+
+  for(i = 0; i < 1000; i++)
+    {
+      record = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
+      record->id = 100 + i;
+      record->value = (i * 7919) % 501;
+      LAttachSorted(list, (lnode_t*)record, unittest_compare, (lloop_e)(i & 1));
+    }
+
+  assert(list->sortindex);
+  assert(LCount(list) == 1007);
+  assert(LVerify(list, unittest_compare) == LLIST_YES);
+
+  match.value = 250;
+  node = LFindSorted(list, unittest_compare, (lnode_t*)&match);
+  assert(node && ((test_record_t*)node)->value == 250);
+  assert(((test_record_t*)LPrev(node))->value < 250);
+
+  LRemove(list, node);
+  LRemoveFirst(list);
   node = LNext(LFirst(list));
-  assert(LPrev(node) == LFirst(list));
-  LMoveAfter(list, LFirst(list), LNext(LFirst(list)));
-  assert(LPrev(node) != LFirst(list));
+  LDetachMany(list, node, 10, LLOOP_FORWARD);
+  LDealloc(node, NULL, NULL);
+  assert(LFindSorted(list, unittest_compare, (lnode_t*)&match));
 
-  node = LPrev(LLast(list));
-  assert(LNext(node) == LLast(list));
-  LMoveBefore(list, LLast(list), LPrev(LLast(list)));
-  assert(LNext(node) != LLast(list));
+  match.value = 1000;
+  assert(LFindSorted(list, unittest_compare, (lnode_t*)&match) == NULL);
 
-  LMoveAfter(list, LFirst(list), LLast(list));
-  LMoveBefore(list, LLast(list), LFirst(list));
+  /* reordering disables index */
+  LReverse(list);
+  assert(!list->sortindex);
+  assert(LSortIndexEnable(list, unittest_compare) == LLIST_NO);
 
-  LMoveAfter(list, LFirst(list), LFirst(list));
-  LMoveBefore(list, LLast(list), LLast(list));
+  LSort(list, unittest_compare);
+  assert(LSortIndexEnable(list, unittest_compare) == LLIST_YES);
+  LRemoveAll(list);
+  assert(list->sortindex);
 
-  unittest_show("reordered", list);
   unittest_dispose_all(list, NULL);
 }
 
 
-/* ------ Testset 3 - detach/attach ------ */
-static void unittest_testset3( void )
+/* ------ Testset 15 - key hash index ------ */
+static void unittest_testset15( void )
 {
-  llist_t * list;
+  llist_t * list  = unittest_generate_list( 4,   10, 20, 30, 40);
+  llist_t * list2 = unittest_generate_list( 2,   50, 60);
+  test_record_t * record = NULL;
+  test_record_t   match;
   lnode_t * node;
-  lnode_t * node1;
-  lnode_t * node2;
+  int id;
 
-  printf("\nTestset 3 - detach/attach.\n\n");
+  printf("\nTestset 15 - key hash index.\n\n");
 
-  list  = unittest_generate_list( 4,   22, 4444, 1, 333);
-  node1 = LDetachFirst(list);
-  node2 = LDetachLast(list);
+  assert(LHashIndexEnable(list, 0, 0, NULL, NULL) == LLIST_NO);
+  assert(LHashIndexEnable(list, offsetof(test_record_t, id), sizeof(int), NULL, NULL) == LLIST_YES);
+  assert(LHashIndexEnable(list2, 0, 0, unittest_hash, unittest_compare) == LLIST_YES);
 
-  assert(node1);
-  assert(node2);
-  assert(list->count == 2); /* 2 nodes in the list */
+  id = 3;
+  node = LLookup(list, &id);
+  assert(node && ((test_record_t*)node)->value == 30);
 
-  LAttachFirst(list, node2);
-  LAttachLast(list, node1);
+  /* created nodes are added after key is set */
+  for(id = 5; id < 200; id++)
+    {
+      record = (test_record_t*)LCreateLast(list);
+      record->id = id;
+      record->value = id * 10;
+      LHashIndexAdd(list, (lnode_t*)record);
+    }
+
+  id = 150;
+  assert(((test_record_t*)LLookup(list, &id))->value == 1500);
+
+  /* detach, remove and attach keep index in sync */
+  node = LLookup(list, &id);
+  LDetach(list, node);
+  assert(LLookup(list, &id) == NULL);
+  LAttachFirst(list, node);
+  assert(LLookup(list, &id) == node);
+
+  LRemove(list, node);
+  assert(LLookup(list, &id) == NULL);
+
+  id = 1;
+  LRemoveFirst(list);
+  assert(LLookup(list, &id) == NULL);
+
+  id = 199;
+  node = LLookup(list, &id);
+  LSort(list, unittest_compare);
+  assert(LLookup(list, &id) == node);
+
+  /* node based keys */
+  match.value = 60;
+  node = LLookup(list2, (lnode_t*)&match);
+  assert(node == LLast(list2));
+
+  /* swap node id 2 (value 20) with list2 node id 2 (value 60) */
+  LSwapBetween(list, LFirst(list), list2, node);
+  assert(LLookup(list2, (lnode_t*)&match) == NULL);
+  id = 2;
+  assert(LLookup(list, &id) == node);
+  match.value = 20;
+  assert(LLookup(list2, (lnode_t*)&match) == LLast(list2));
+
+  LJoin(list2, &list);
+  assert(LLookup(list2, (lnode_t*)&match) == LNext(LFirst(list2)));
+  match.value = 1990;
+  assert(((test_record_t*)LLookup(list2, (lnode_t*)&match))->id == 199);
+
+  LRemoveAll(list2);
+  assert(LLookup(list2, (lnode_t*)&match) == NULL);
+
+  unittest_dispose_all(list2, NULL);
+}
+
+
+/* ------ Testset 16 - compact ------ */
+static unsigned unittest_relocated = 0;
+
+static void unittest_relocate(lnode_t* node, const lnode_t* old_node)
+{
+  assert(((test_record_t*)node)->id == ((test_record_t*)old_node)->id);
+  unittest_relocated++;
+}
+
+static void unittest_testset16( void )
+{
+  llist_t * list = unittest_generate_list( 8,   1, 2, 3, 4, 5, 6, 7, 8);
+  llist_t * copy = NULL;
+  int id = 5;
+
+  printf("\nTestset 16 - compact.\n\n");
+
+  LShuffle(list, NULL);
+  LFilterClone(list, &copy, NULL, 0);
+  assert(LHashIndexEnable(list, offsetof(test_record_t, id), sizeof(int), NULL, NULL) == LLIST_YES);
+
+  assert(LCompact(list, unittest_relocate) == LLIST_YES);
+  assert(unittest_relocated == 8);
+  unittest_show("compacted", list);
+  assert(LCompare(list, copy, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+  assert(((test_record_t*)LLookup(list, &id))->value == 5);
+
+  LSort(list, unittest_compare);
+  assert(LSortIndexEnable(list, unittest_compare) == LLIST_YES);
+  assert(LCompact(list, NULL) == LLIST_YES);
+  assert(list->sortindex);
+  assert(LFindSorted(list, unittest_compare, LLast(list)) == LLast(list));
+
+  unittest_dispose_all(list, copy, NULL);
+
+  /* out of memory leaves the list as it was */
+  {
+    void *    pool   = MPoolInit(sizeof(test_record_t), MPOOL_NOWAIT, MPOOL_ZERO_MEMSET);
+    llist_t * pooled = LInit(sizeof(test_record_t), NULL, pool);
+    lnode_t * first;
+    int       i;
+
+    for(i = 0; i < 100; i++)
+      {
+        ((test_record_t*)LCreateLast(pooled))->value = i;
+      }
+
+    first = LFirst(pooled);
+    os_block_alloc_occupied = LLIST_YES;
+    assert(LCompact(pooled, NULL) == LLIST_NO);
+    os_block_alloc_occupied = LLIST_NO;
+
+    assert(LFirst(pooled) == first && LCount(pooled) == 100);
+    assert(((test_record_t*)LLast(pooled))->value == 99);
+    assert(MPoolGetStatistics(pool).blocks_used == 100);
+
+    assert(LCompact(pooled, NULL) == LLIST_YES);
+    assert(LFirst(pooled) != first && ((test_record_t*)LLast(pooled))->value == 99);
+
+    LDispose(&pooled);
+    MPoolDispose(&pool);
+  }
+}
+
+/* ------ Testset 17 - prefetch benchmark ------ */
+#define UNITTEST_BENCH_NODES  200000
+
+static lbool_e unittest_filter_heavy(const lnode_t* node, unsigned user_data)
+{
+  unsigned hash = (unsigned)((test_record_t*)node)->value;
+  unsigned i;
+
+  /* callback work which fetch of the next nodes can overlap */
+  for(i = 0; i < 100; i++)
+    {
+      hash = hash * 2654435761u + user_data;
+    }
+
+  return (hash & 1 ? LLIST_YES : LLIST_NO);
+}
 
-  assert(list->count == 4); /* 4 node in the list */
-  unittest_show("", list);
+static void unittest_testset17( void )
+{
+  llist_t * list = LInit(sizeof(test_record_t), NULL, NULL);
+  test_record_t * record;
+  clock_t start_time;
+  unsigned i;
 
-  node1 = LFirst(list);
-  LDetachMany(list, node1, 3, LLOOP_FORWARD);
-  assert(LDetachCount(node1, LLOOP_FORWARD) == 3);
+  printf("\nTestset 17 - prefetch benchmark (distance %d).\n\n", LLIST_PREFETCH_DISTANCE);
 
-  assert(list->count == 1); /* 1 node in the list */
-  unittest_show("", list);
+  for(i = 0; i < UNITTEST_BENCH_NODES; i++)
+    {
+      record = (test_record_t*)LCreateLast(list);
+      record->id    = (int)i;
+      record->value = (int)i;
+    }
 
-  node2 = LFirst(list);
-  LDetachMany(list, node2, 0, LLOOP_FORWARD); /* detach rest */
-  assert(LDetachCount(node2, LLOOP_FORWARD) == 1);
+  /*
+   *  Scatter the list order over memory, still keeping values sorted.
+   */
+  LShuffle(list, NULL);
 
-  LAttachLast(list, node2);
-  node2 = LDetachFirst(list);
-  LAttachLast(list, node2);
-  node2 = LDetachLast(list);
-  LAttachLast(list, node2);
+  i = 0;
+  LFor(test_record_t*, record, list)
+    {
+      record->value = (int)i++;
+    }
 
-  LAttachLast(list, node1);
-  assert(list->count == 4); /* 4 nodes in the list */
-  unittest_show("", list);
+  start_time = clock();
 
-  node = LNext(LFirst(list));
-  LDetachMany(list, node, 2, LLOOP_FORWARD);
-  assert(LNext(LFirst(list)) == LLast(list));
-  assert(LPrev(LLast(list)) == LFirst(list));
-  LAttachAfter(list, node, LFirst(list));
+  for(i = 0; i < 10; i++)
+    {
+      assert(LFilterCount(list, unittest_filter, UNITTEST_BENCH_NODES / 2) == UNITTEST_BENCH_NODES / 2 - 1);
+      assert(LVerify(list, unittest_compare) == LLIST_YES);
+      assert(LFindNode(LFirst(list), unittest_filter, UNITTEST_BENCH_NODES, LLOOP_FORWARD) == NULL);
+      LReverse(list);
+      LReverse(list);
+    }
 
-  node = LNext(LFirst(list));
-  LDetachMany(list, LNext(node), 2, LLOOP_BACKWARD);
-  LAttachBefore(list, node, LLast(list));
+  printf("scattered traversals %d ms\n", (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC));
 
-  node = LDetachAll(list);
-  assert(LCount(list) == 0);
-  assert(LDetachCount(node, LLOOP_FORWARD) == 4);
-  assert(LDetachCount(LNext(LNext(node)), LLOOP_BACKWARD) == 3);
-  LAttachBefore(list, node, LFirst(list));
-  assert(LCount(list) == 4); /* 4 nodes in the list */
+  start_time = clock();
 
-  unittest_show("", list);
-  unittest_dispose_all(list, NULL);
-}
+  for(i = 0; i < 10; i++)
+    {
+      (void)LFilterCount(list, unittest_filter_heavy, 1);
+    }
 
+  printf("scattered traversals with callback work %d ms\n", (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC));
 
-/* ------ Testset 4 - detach/attach ------ */
-static void unittest_testset4( void )
-{
-  test_record_t * record = NULL;
-  llist_t * list  = unittest_generate_list( 4,   22, 4444, 1, 333);
-  lnode_t * node;
+  assert(LCompact(list, NULL) == LLIST_YES);
 
-  printf("\nTestset 4 - alloc/dealloc.\n\n");
+  start_time = clock();
 
-  unittest_show("", list);
+  for(i = 0; i < 10; i++)
+    {
+      assert(LFilterCount(list, unittest_filter, UNITTEST_BENCH_NODES / 2) == UNITTEST_BENCH_NODES / 2 - 1);
+      assert(LVerify(list, unittest_compare) == LLIST_YES);
+      assert(LFindNode(LFirst(list), unittest_filter, UNITTEST_BENCH_NODES, LLOOP_FORWARD) == NULL);
+      LReverse(list);
+      LReverse(list);
+    }
 
-  node = LFirst(list);
-  LDetachMany(list, node, 2, LLOOP_FORWARD);
-  LDealloc(LNext(node), NULL, NULL);
+  printf("compacted traversals %d ms\n", (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC));
 
-  unittest_show("", list);
+  LDispose(&list);
+}
 
-  record = (test_record_t*)LAlloc( sizeof(test_record_t), LLIST_YES);
-  record->id = 2;
-  record->value = 22;
+/* ------ Testset 18 - parallel filtering ------ */
+static void unittest_workers(NodeTask_f Task, void * tasks[], unsigned count)
+{
+  /* runs tasks in reverse order, to catch any dependency between them */
+  while(count--)
+    {
+      Task(tasks[count]);
+    }
+}
 
-  LAttachFirst(list, (lnode_t*)record);
+/* runs each task in thread of its own */
+#define UNITTEST_THREADS  8
 
-  record = (test_record_t*)LAlloc( sizeof(test_record_t), LLIST_NO);
-  record->id = 3;
-  record->value = 333;
+typedef struct
+{
+  NodeTask_f Task;
+  void *     task;
+} test_thread_t;
 
-  LAttachFirst(list, (lnode_t*)record);
+static void * unittest_thread(void * arg)
+{
+  test_thread_t * thread = (test_thread_t*)arg;
 
-  unittest_show("", list);
-  unittest_dispose_all(list, NULL);
+  thread->Task(thread->task);
+  return NULL;
 }
 
-
-/* ------ Testset 5 - indecis ------ */
-static void unittest_testset5( void )
+static void unittest_thread_workers(NodeTask_f Task, void * tasks[], unsigned count)
 {
-  llist_t * list  = unittest_generate_list( 4,   22, 4444, 1, 333);
-  lnode_t * node;
-  int index;
+  pthread_t     threads[UNITTEST_THREADS];
+  test_thread_t args[UNITTEST_THREADS];
+  unsigned      i;
+  int           rc;
 
-  printf("\nTestset 5 - indecis.\n\n");
+  assert(count <= UNITTEST_THREADS);
 
-  node = LGetNode(list, 0);
-  assert(node == LFirst(list));
+  for(i = 0; i < count; i++)
+    {
+      args[i].Task = Task;
+      args[i].task = tasks[i];
+      rc = pthread_create(&threads[i], NULL, unittest_thread, &args[i]);
+      assert(rc == 0);
+    }
 
-  node = LGetNode(list, -100);
-  assert(node);
+  for(i = 0; i < count; i++)
+    {
+      (void)pthread_join(threads[i], NULL);
+    }
+}
 
-  node = LGetNode(list, LCount(list)-2);
-  assert(node);
-  assert(((test_record_t*)node)->id == 3);
+static lbool_e unittest_increase(const lnode_t* node, unsigned user_data)
+{
+  ((test_record_t*)node)->value += user_data;
+  return LLIST_YES;
+}
 
-  index = LSetIndex(list, NULL,  0);
-  assert(index == -1);
+static void unittest_testset18( void )
+{
+  llist_t * list  = unittest_generate_list( 11,  10, 200, 30, 400, 50, 600, 70, 800, 90, 1000, 110);
+  llist_t * check = unittest_generate_list( 8,   10, 30, 50, 70, 90, 201, 401, 111);
+  llist_t * moved = NULL;
+  llist_t * other = NULL;
+  unsigned  i;
+
+  printf("\nTestset 18 - parallel filtering.\n\n");
+
+  assert(LParallelFilterCount(list, unittest_filter, 100, unittest_workers, 4) == 6);
+  assert(LParallelFilterCount(list, unittest_filter, 100, unittest_workers, 11) == 6);
+  assert(LParallelFilterCount(list, unittest_filter, 100, unittest_workers, 12) == 6);
+  assert(LParallelFilterOperate(list, unittest_filter, 100, unittest_increase, 1, unittest_workers, 3) == 6);
+  assert(LParallelFilterCount(list, unittest_filter, 100, NULL, 3) == 6);
+
+  LParallelFilterMove(list, &moved, unittest_filter, 100, unittest_workers, 3);
+  unittest_show("kept", list);
+  unittest_show("moved", moved);
+  assert(LCount(list) == 5);
+  assert(LCount(moved) == 6);
+  assert(((test_record_t*)LFirst(moved))->value == 201);
+  assert(((test_record_t*)LLast(moved))->value == 111);
+
+  assert(LParallelFilterRemove(moved, unittest_filter, 500, unittest_workers, 2) == 3);
+  unittest_show("remaining", moved);
+  assert(LCount(moved) == 3);
+
+  LJoin(list, &moved);
+  assert(LCompare(list, check, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+
+  unittest_dispose_all(list, check, NULL);
+
+  /* segments in threads against serial filtering of same list */
+  list  = LInit(sizeof(test_record_t), NULL, NULL);
+  check = LInit(sizeof(test_record_t), NULL, NULL);
+
+  for(i = 0; i < 100003; i++)
+    {
+      ((test_record_t*)LCreateLast(list))->value  = (int)(i * 7919 % 1000);
+      ((test_record_t*)LCreateLast(check))->value = (int)(i * 7919 % 1000);
+    }
 
-  node = LGetNode(list, -100);
-  assert(node);
+  assert(LParallelFilterCount(list, unittest_filter, 500, unittest_thread_workers, UNITTEST_THREADS) ==
+         LFilterCount(check, unittest_filter, 500));
+  assert(LParallelFilterOperate(list, unittest_filter, 200, unittest_increase, 3, unittest_thread_workers, 5) ==
+         LFilterOperate(check, unittest_filter, 200, unittest_increase, 3));
+  assert(LCompare(list, check, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
 
-  index = LSetIndex(list, node, 100);
-  assert(index == LLastIndex(list));
+  LParallelFilterMove(list, &moved, unittest_filter, 700, unittest_thread_workers, UNITTEST_THREADS);
+  LFilterMove(check, &other, unittest_filter, 700);
+  assert(LCompare(list, check, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+  assert(LCompare(moved, other, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
 
-  (void)LSetIndex(list, node, 1);
-  index = LGetIndex(list, node);
-  assert(index == 1);
+  /* backward links as well */
+  LReverse(list);
+  LReverse(check);
+  assert(LCompare(list, check, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
 
-  unittest_show("", list);
-  unittest_dispose_all(list, NULL);
-}
+  assert(LParallelFilterRemove(moved, unittest_filter, 900, unittest_thread_workers, 7) ==
+         LFilterRemove(other, unittest_filter, 900));
+  LReverse(moved);
+  LReverse(other);
+  assert(LCompare(moved, other, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
 
+  unittest_dispose_all(list, check, moved, other, NULL);
+}
 
-/* ------ Testset 6 - split/join ------ */
-static void unittest_testset6( void )
+/* ------ Testset 19 - create many ------ */
+static void unittest_testset19( void )
 {
-  llist_t * list   = unittest_generate_list( 4,   1, 22, 333, 4444);
-  llist_t * c1list = NULL;
+  llist_t * list  = unittest_generate_list( 2,   1, 5);
+  llist_t * check = unittest_generate_list( 7,   0, 0, 1, 2, 3, 5, 6);
+  test_record_t * record;
+  int value = 2;
 
-  printf("\nTestset 6 - split/join.\n\n");
+  printf("\nTestset 19 - create many.\n\n");
 
-  c1list = LSplit(list, LNext(LFirst(list)));
-  unittest_show("orginal", list);
-  unittest_show("splitted", c1list);
+  assert(LCreateMany(list, 0, NULL) == NULL);
+  record = (test_record_t*)LCreateMany(list, 2, LFirst(list));
+  assert(record == (test_record_t*)LNext(LFirst(list)));
+  record->value = value++;
+  ((test_record_t*)LNext(record))->value = value++;
+  assert(LCount(list) == 4);
 
-  LJoin(list, &c1list);
-  unittest_show("orginal", list);
-  unittest_show("splitted", c1list);
+  record = (test_record_t*)LCreateMany(list, 1, LLast(list));
+  assert(record == (test_record_t*)LLast(list));
+  record->value = 6;
 
-  c1list = LSplit(list, LFirst(list));
-  unittest_show("orginal", list);
-  unittest_show("splitted", c1list);
+  record = (test_record_t*)LCreateMany(list, 2, NULL);
+  assert(record == (test_record_t*)LFirst(list));
+  assert(record->value == 0 && ((test_record_t*)LNext(record))->value == 0);
 
-  LJoin(list, &c1list);
-  unittest_show("orginal", list);
-  unittest_show("splitted", c1list);
+  unittest_show("created", list);
+  assert(LCompare(list, check, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
 
-  assert(list->count == 4); /* 4 nodes in the list */
-  unittest_dispose_all(list, c1list, NULL);
+  LRemoveAll(list);
+  record = (test_record_t*)LCreateMany(list, 3, LLast(list));
+  assert(record == (test_record_t*)LFirst(list));
+  assert(LCount(list) == 3);
+  unittest_show("created", list);
+
+  unittest_dispose_all(list, check, NULL);
 }
 
+/* ------ Testset 20 - range splice ------ */
+static void unittest_testset20( void )
+{
+  llist_t * list   = unittest_generate_list( 6,   1, 2, 3, 4, 5, 6);
+  llist_t * other  = unittest_generate_list( 2,   10, 20);
+  llist_t * check1 = unittest_generate_list( 2,   1, 6);
+  llist_t * check2 = unittest_generate_list( 6,   10, 2, 3, 4, 5, 20);
+  llist_t * check3 = unittest_generate_list( 6,   4, 5, 10, 2, 3, 20);
+  int id = 4;
+
+  printf("\nTestset 20 - range splice.\n\n");
+
+  assert(LHashIndexEnable(list, offsetof(test_record_t, id), sizeof(int), NULL, NULL) == LLIST_YES);
+
+  LSpliceRange(other, LFirst(other), list, LNext(LFirst(list)), LPrev(LLast(list)), 4);
+  unittest_show("source", list);
+  unittest_show("destination", other);
+  assert(LCompare(list,  check1, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+  assert(LCompare(other, check2, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+  assert(LLookup(list, &id) == NULL);
+
+  /* inside same list, to the beginning */
+  LSpliceRange(other, NULL, other, LNext(LNext(LNext(LFirst(other)))), LPrev(LLast(other)), 0);
+  unittest_show("moved", other);
+  assert(LCompare(other, check3, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+
+  /* all nodes into empty list, count unknown */
+  LSpliceRange(list, NULL, other, LFirst(other), LLast(other), 0);
+  LRemoveAll(other);
+  LSpliceRange(other, LLast(other), list, LFirst(list), LLast(list), 0);
+  assert(LCount(list) == 0 && !LFirst(list) && !LLast(list));
+  assert(LCount(other) == 8);
+  unittest_show("all", other);
+
+  unittest_dispose_all(list, other, check1, check2, check3, NULL);
+}
 
-/* ------ Testset 7 - swapping inside ------ */
-static void unittest_testset7( void )
+/* ------ Testset 21 - set operations ------ */
+static void unittest_set_check( llist_t * list, llist_t * other, llist_t * check1, llist_t * check2 )
 {
-  llist_t * list = unittest_generate_list( 4,   1, 22, 333, 4444);
+  unittest_show("result", list);
+  unittest_show("rest", other);
+  assert(LCompare(list,  check1, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+  assert(LCompare(other, check2, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+  unittest_dispose_all(list, other, check1, check2, NULL);
+}
 
-  printf("\nTestset 7 - swapping inside.\n\n");
+static void unittest_testset21( void )
+{
+  llist_t * list;
+  llist_t * other;
+
+  printf("\nTestset 21 - set operations.\n\n");
+
+  list  = unittest_generate_list( 6,   1, 2, 2, 4, 6, 8);
+  other = unittest_generate_list( 5,   0, 2, 5, 6, 9);
+  LSetUnion(list, other, unittest_compare);
+  unittest_set_check(list, other, unittest_generate_list( 9,   0, 1, 2, 2, 4, 5, 6, 8, 9),
+                                  unittest_generate_list( 2,   2, 6));
+
+  list  = unittest_generate_list( 6,   1, 2, 2, 4, 6, 8);
+  other = unittest_generate_list( 5,   0, 2, 5, 6, 9);
+  LSetIntersect(list, other, unittest_compare);
+  unittest_set_check(list, other, unittest_generate_list( 2,   2, 6),
+                                  unittest_generate_list( 9,   0, 1, 2, 2, 4, 5, 6, 8, 9));
+
+  list  = unittest_generate_list( 6,   1, 2, 2, 4, 6, 8);
+  other = unittest_generate_list( 5,   0, 2, 5, 6, 9);
+  LSetDiff(list, other, unittest_compare);
+  unittest_set_check(list, other, unittest_generate_list( 4,   1, 2, 4, 8),
+                                  unittest_generate_list( 7,   0, 2, 2, 5, 6, 6, 9));
+
+  list  = unittest_generate_list( 6,   1, 2, 2, 4, 6, 8);
+  other = unittest_generate_list( 5,   0, 2, 5, 6, 9);
+  LSetSymDiff(list, other, unittest_compare);
+  unittest_set_check(list, other, unittest_generate_list( 7,   0, 1, 2, 4, 5, 8, 9),
+                                  unittest_generate_list( 4,   2, 2, 6, 6));
+
+  list  = unittest_generate_list( 0 );
+  other = unittest_generate_list( 2,   3, 4);
+  LSetUnion(list, other, unittest_compare);
+  assert(LCount(list) == 2 && LCount(other) == 0 && !LFirst(other) && !LLast(other));
+  unittest_dispose_all(list, other, NULL);
+}
 
-  LSwapInside(list, LFirst(list), LFirst(list));
+/* ------ Testset 22 - k-way merge ------ */
+static void unittest_testset22( void )
+{
+  llist_t * lists[5];
+  lnode_t * equal[3];
+  lcolumn_t column;
+  llist_t * check = unittest_generate_list( 12,   1, 1, 2, 3, 3, 3, 5, 7, 8, 9, 10, 12);
+  test_record_t * record;
+  int id = 2;
 
-  unittest_show("", list);
+  printf("\nTestset 22 - k-way merge.\n\n");
 
-  LSwapInside(list, LNext(LFirst(list)), LLast(list));
-  LSwapInside(list, LPrev(LLast(list)),  LFirst(list));
+  lists[0] = unittest_generate_list( 4,   1, 3, 5, 7);
+  lists[1] = unittest_generate_list( 0 );
+  lists[2] = unittest_generate_list( 3,   2, 3, 12);
+  lists[3] = unittest_generate_list( 4,   1, 3, 8, 9);
+  lists[4] = unittest_generate_list( 1,   10);
 
-  LSwapInside(list, LFirst(list), LLast(list));
+  assert(LHashIndexEnable(lists[0], offsetof(test_record_t, value), sizeof(int), NULL, NULL) == LLIST_YES);
 
-  LSwapInside(list, LLast(list),  LNext(LFirst(list)));
-  LSwapInside(list, LFirst(list), LPrev(LLast(list)));
+  equal[0] = LGetNode(lists[0], 1);
+  equal[1] = LGetNode(lists[2], 1);
+  equal[2] = LGetNode(lists[3], 1);
 
-  unittest_show("", list);
+  /* emptied inputs are seen as changed */
+  assert(LVerify(lists[2], unittest_compare) == LLIST_YES);
+  LColumnSetup(&column, lists[2], offsetof(test_record_t, value));
+  assert(LColumnCount(&column, -100, 100) == 3);
 
-  LSwapInside(list, LNext(LFirst(list)), LFirst(list));
-  LSwapInside(list, LPrev(LLast(list)),  LLast(list));
+  LMergeK(lists, 5, unittest_compare);
+  assert(LColumnCount(&column, -100, 100) == 0);
+  assert(lists[2]->sortedby == NULL);
+  LColumnDispose(&column);
+  unittest_show("merged", lists[0]);
+  assert(LCompare(lists[0], check, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+  assert(LCount(lists[2]) == 0 && !LFirst(lists[3]) && !LLast(lists[4]));
+  assert(((test_record_t*)LLookup(lists[0], &id))->id == 1);
 
-  LSwapInside(list, LFirst(list), LNext(LFirst(list)));
+  /* stable, equal nodes in list order (value 3 from lists 0, 2 and 3) */
+  record = (test_record_t*)LGetNode(lists[0], 3);
+  assert((lnode_t*)record == equal[0]);
+  assert(LNext(equal[0]) == equal[1] && LNext(equal[1]) == equal[2]);
 
-  LSwapInside(list, LFirst(list), LNext(LFirst(list)));
-  LSwapInside(list, LLast(list),  LPrev(LLast(list)));
+  LMergeK(lists, 1, unittest_compare);
+  assert(LCount(lists[0]) == 12);
 
-  unittest_show("", list);
-  unittest_dispose_all(list, NULL);
+  unittest_dispose_all(lists[0], lists[1], lists[2], lists[3], lists[4], check, NULL);
 }
 
 
-/* ------ Testset 8 - filtering ------ */
-static void unittest_testset8( void )
+/* ------ Testset 23 - relocatable image ------ */
+static void unittest_testset23( void )
 {
-  llist_t * list    = unittest_generate_list( 4,   1, 22, 333, 4444);
-  llist_t * list2   = unittest_generate_list( 11,  10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110);
-  llist_t * unique1 = unittest_generate_list( 7,   2, 2, 2, 4, 5, 5, 5);
-  llist_t * unique2 = unittest_generate_list( 7,   2, 2, 2, 4, 5, 5, 5);
-  llist_t * c1list  = NULL;
-  llist_t * c2list  = NULL;
+  llist_t * list   = unittest_generate_list( 5,   50, 10, 40, 20, 30);
+  llist_t * loaded = LInit(sizeof(test_record_t), NULL, NULL);
+  size_t    size   = LImageSize(list);
+  char *    image  = (char*)os_block_alloc(size);
+  char *    moved  = (char*)os_block_alloc(size + 8);
+  test_record_t * record;
+  lnode_t * node;
+  FILE *    file;
+  unsigned  i;
+  clock_t   time;
+  int       ids[] = { 1, 2, 3, 4, 5 };
+  llist_t   large;
+
+  printf("\nTestset 23 - relocatable image.\n\n");
+
+  assert(size == sizeof(limage_t) + 5 * sizeof(test_record_t));
+  assert(LImageWrite(list, image, size - 1) == LLIST_NO);
+  assert(LImageWrite(list, image, size) == LLIST_YES);
+
+  /* through file into other address */
+  file = tmpfile();
+  assert(file && fwrite(image, 1, size, file) == size);
+  rewind(file);
+  assert(fread(moved + 8, 1, size, file) == size);
+  fclose(file);
+
+  i = 0;
+  LImageFor(test_record_t*, record, moved + 8)
+    {
+      assert(record->id == ids[i++]);
+    }
 
-  printf("\nTestset 8 - clone.\n\n");
+  assert(i == 5 && LImageCount(moved + 8) == 5);
+  record = (test_record_t*)LImagePrev(moved + 8, LImageNext(moved + 8, LImageFirst(moved + 8)));
+  assert(record->id == 1 && record->value == 50);
+
+  /* broken link is rejected and image restored */
+  node = LImageNext(moved + 8, LImageNext(moved + 8, LImageNext(moved + 8, LImageFirst(moved + 8))));
+  node->next = (lnode_t*)((size_t)node->next + 1);
+  assert(LImageLoad(loaded, moved + 8, size) == LLIST_NO);
+  assert(LCount(loaded) == 0);
+  node->next = (lnode_t*)((size_t)node->next - 1);
+  assert(memcmp(moved + 8, image, size) == 0);
+
+  assert(LImageLoad(loaded, moved + 8, size - 1) == LLIST_NO);
+  assert(LImageLoad(list, moved + 8, size) == LLIST_NO);
+
+  assert(LHashIndexEnable(loaded, offsetof(test_record_t, value), sizeof(int), NULL, NULL) == LLIST_YES);
+  assert(LImageLoad(loaded, moved + 8, size) == LLIST_YES);
+  unittest_show("loaded", loaded);
+  assert(LCompare(loaded, list, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+  assert((char*)LFirst(loaded) == moved + 8 + sizeof(limage_t));
+  i = 40;
+  assert(((test_record_t*)LLookup(loaded, &i))->id == 3);
+
+  (void)LDetachAll(loaded);
+  LHashIndexDisable(loaded);
+  ((limage_t*)image)->link_size++;
+  assert(LImageLoad(loaded, image, size) == LLIST_NO);
+  ((limage_t*)image)->link_size--;
+
+  /* links must be aligned in image */
+  memcpy(moved + 4, image, size);
+  assert(LImageLoad(loaded, moved + 4, size) == LLIST_NO);
+  assert(LImageWrite(list, moved + 4, size) == LLIST_NO);
+  ((limage_t*)image)->node_size += 4;
+  ((limage_t*)image)->size += 4 * 5;
+  assert(LImageLoad(loaded, image, size + 4 * 5) == LLIST_NO);
+  ((limage_t*)image)->node_size -= 4;
+  ((limage_t*)image)->size -= 4 * 5;
+  list->node_size += 4;
+  assert(LImageSize(list) == 0);
+  list->node_size -= 4;
+  assert(LImageLoad(loaded, image, size) == LLIST_YES);
+  (void)LDetachAll(loaded);
+
+  ((limage_t*)image)->count = ~0u;
+  assert(LImageLoad(loaded, image, size) == LLIST_NO);
+
+  /* size of large image, only list header is needed */
+  LSetup(large, 1u << 20, NULL);
+  large.count = 1u << 13;
+
+  if (sizeof(size_t) > sizeof(unsigned))
+    {
+      assert(LImageSize(&large) == sizeof(limage_t) + ((size_t)1 << 33));
+      large.count = ~0u;
+      large.node_size = ~0u - (sizeof(lnode_t*) - 1);
+      assert(LImageSize(&large) == sizeof(limage_t) + (size_t)~0u * large.node_size);
+    }
+  else
+    {
+      assert(LImageSize(&large) == 0);
+    }
 
-  LFilterClone(list, &c1list, NULL, 0);
-  unittest_show("orginal", list);
-  unittest_show("clone1", c1list);
+  assert(LImageWrite(&large, image, size) == LLIST_NO);
 
-  LFilterClone(list, &c2list, unittest_clone, 10000);
-  unittest_show("clone2", c2list);
+  os_block_dealloc(image);
+  os_block_dealloc(moved);
+  unittest_dispose_all(list, NULL);
 
-  LRemoveAll(c2list);
-  LFilterClone(list, &c2list, unittest_clone, 10000);
-  unittest_show("clone2", c2list);
+  /* load against rebuild */
+  list = LInit(sizeof(test_record_t), NULL, NULL);
 
-  LDispose(&c2list);
-  LFilterMove(list, &c2list, unittest_filter, 22);
-  unittest_show("filtered", c2list);
+  time = clock();
 
-  LRemoveAll(c2list);
-  LFilterMove(list, &c2list, unittest_filter, 22);
-  unittest_show("filtered", c2list);
+  for(i = 0; i < UNITTEST_BENCH_NODES; i++)
+    {
+      record = (test_record_t*)LCreateLast(list);
+      record->id = (int)i;
+    }
 
-  unittest_show("filtered(count)", list2);
-  assert(LFilterCount(list2, unittest_filter, 70) == 4);
-  
-  assert(LFilterOperate(list2, unittest_filter, 70, unittest_operate, 1000) == 4);
-  unittest_show("filtered(operate)", list2);
+  printf("Rebuilt %u nodes in %u ms\n", UNITTEST_BENCH_NODES,
+         (unsigned)((clock() - time) * 1000 / CLOCKS_PER_SEC));
 
-  assert(LFilterRemove(list2, unittest_filter, 20) == 9);
-  unittest_show("filtered(remove)", list2);
+  size  = LImageSize(list);
+  image = (char*)os_block_alloc(size);
+  assert(LImageWrite(list, image, size) == LLIST_YES);
 
-  unittest_show("duplicates", unique1);
-  LUnique(unique1, unittest_compare, LLOOP_FORWARD);
-  unittest_show("duplicates", unique1);
-  assert( ((test_record_t*)LFirst(unique1))->id == 1 );
-  assert( ((test_record_t*)LLast(unique1))->id  == 5 );
+  time = clock();
+  assert(LImageLoad(loaded, image, size) == LLIST_YES);
 
-  unittest_show("duplicates", unique2);
-  LUnique(unique2, unittest_compare, LLOOP_BACKWARD);
-  unittest_show("duplicates", unique2);
-  assert( ((test_record_t*)LFirst(unique2))->id == 3 );
-  assert( ((test_record_t*)LLast(unique2))->id  == 7 );
+  printf("Loaded  %u nodes in %u ms\n", UNITTEST_BENCH_NODES,
+         (unsigned)((clock() - time) * 1000 / CLOCKS_PER_SEC));
+
+  assert(LCount(loaded) == UNITTEST_BENCH_NODES);
+  assert(((test_record_t*)LLast(loaded))->id == UNITTEST_BENCH_NODES - 1);
 
-  unittest_dispose_all(list, list2, c1list, c2list, NULL);
+  (void)LDetachAll(loaded);
+  os_block_dealloc(image);
+  unittest_dispose_all(list, loaded, NULL);
 }
 
 
-/* ------ Testset 9 - swapping between------ */
-static void unittest_testset9( void )
+/* ------ Testset 24 - column scanning ------ */
+static void unittest_testset24( void )
 {
-  llist_t * c1list = unittest_generate_list( 4,   1, 22, 333, 4444);
-  llist_t * c2list = unittest_generate_list( 4,   1, 22, 333, 4444);
+  llist_t * list = unittest_generate_list( 11,   5, -3, 7, 7, 0, 12, -8, 7, 3, 9, 2);
+  lcolumn_t column;
+  test_record_t * record;
+  unsigned  position = 0;
+  unsigned  i;
+  clock_t   start_time;
+  int       ids[] = { 3, 4, 8 };
 
-  printf("\nTestset 9 - swapping between.\n\n");
+  printf("\nTestset 24 - column scanning.\n\n");
 
-  LSwapBetween(c1list, LFirst(c1list), c1list, LFirst(c1list));
+  LColumnSetup(&column, list, offsetof(test_record_t, value));
 
-  unittest_show("clone1", c1list);
-  unittest_show("clone2", c2list);
+  assert(LColumnCount(&column, 7, 7) == 3);
+  assert(LColumnCount(&column, -5, 5) == 5);
+  assert(LColumnCount(&column, 13, 100) == 0);
+  assert(LColumnCount(&column, -100, 100) == 11);
 
-  LSwapBetween(c1list, LFirst(c1list), c2list, LFirst(c2list));
-  LSwapBetween(c1list, LLast(c1list), c2list, LLast(c2list));
+  for(i = 0; (record = (test_record_t*)LColumnFind(&column, 7, 7, &position)) != NULL; i++)
+    {
+      assert(record->id == ids[i]);
+    }
 
-  LSwapBetween(c1list, LNext(LFirst(c1list)), c2list, LPrev(LLast(c2list)));
+  assert(i == 3 && position == 11);
 
-  unittest_show("clone1", c1list);
-  unittest_show("clone2", c2list);
+  /* list changes are seen by version */
+  LRemoveFirst(list);
+  LMoveFirst(list, LLast(list));
+  position = 0;
+  assert(((test_record_t*)LColumnFind(&column, -100, 100, &position))->value == 2);
+  assert(LColumnCount(&column, -100, 100) == 10);
 
-  LSwapBetween(c1list, LFirst(c1list), c2list, LLast(c2list));
-  LSwapBetween(c1list, LLast(c1list), c2list, LFirst(c2list));
+  /* value changes are not */
+  ((test_record_t*)LFirst(list))->value = 7;
+  assert(LColumnCount(&column, 7, 7) == 3);
+  LColumnInvalidate(&column);
+  assert(LColumnCount(&column, 7, 7) == 4);
 
-  LSwapBetween(c1list, LNext(LFirst(c1list)), c2list, LPrev(LLast(c2list)));
+  LRemoveAll(list);
+  position = 0;
+  assert(LColumnCount(&column, -100, 100) == 0);
+  assert(LColumnFind(&column, -100, 100, &position) == NULL);
 
-  unittest_show("clone1", c1list);
-  unittest_show("clone2", c2list);
+  LColumnDispose(&column);
+  unittest_dispose_all(list, NULL);
 
-  LSwapAll(c1list, c2list);
+  /* against filter callbacks */
+  list = LInit(sizeof(test_record_t), NULL, NULL);
 
-  unittest_show("clone1", c1list);
-  unittest_show("clone2", c2list);
+  for(i = 0; i < UNITTEST_BENCH_NODES; i++)
+    {
+      record = (test_record_t*)LCreateLast(list);
+      record->id    = (int)i;
+      record->value = (int)i;
+    }
 
-  LSwapAll(c1list, c2list);
+  LShuffle(list, NULL);
+  LColumnSetup(&column, list, offsetof(test_record_t, value));
 
-  unittest_dispose_all( c1list, c2list, NULL);
-}
+  start_time = clock();
 
+  for(i = 0; i < 10; i++)
+    {
+      assert(LFilterCount(list, unittest_filter, UNITTEST_BENCH_NODES / 2) == UNITTEST_BENCH_NODES / 2 - 1);
+    }
 
-/* ------ Testset 10 - compare ------ */
-static void unittest_testset10( void )
-{
-  llist_t * orginal   = unittest_generate_list( 6,   1, 2, 3, 4, 5, 6);
-  llist_t * inorder   = unittest_generate_list( 6,   1, 2, 3, 4, 5, 6);
-  llist_t * reverse   = unittest_generate_list( 6,   6, 5, 4, 3, 2, 1);
-  llist_t * nonorder  = unittest_generate_list( 6,   4, 5, 1, 2, 3, 6);
-  llist_t * subset    = unittest_generate_list( 4,   2, 3, 4, 5);
-  llist_t * revsubset = unittest_generate_list( 4,   5, 4, 3, 2);
-  llist_t * included  = unittest_generate_list( 4,   1, 3, 4, 6);
-  llist_t * covered   = unittest_generate_list( 6,   1, 1, 6, 5, 4, 5);
-  llist_t * partial   = unittest_generate_list( 2,   2,  99 );
-  llist_t * nothing   = unittest_generate_list( 2,   88, 99 );
-  llist_t * nothing2  = unittest_generate_list( 6,   11, 22, 33, 44, 55, 66 );
-  lnode_t * node;
+  printf("filter count %d ms\n", (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC));
 
-  printf("\nTestset 10 - compare.\n\n");
+  start_time = clock();
+  assert(LColumnCount(&column, UNITTEST_BENCH_NODES / 2 + 1, UNITTEST_BENCH_NODES) == UNITTEST_BENCH_NODES / 2 - 1);
 
-  unittest_show("orginal", orginal);
+  printf("column build %d ms\n", (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC));
 
-  node = LFirst(orginal);
-  assert(LContains(orginal, node));
-  assert(!LContains(nothing, node));
+  start_time = clock();
 
-  assert(LCompare(inorder,   orginal, unittest_compare) == LLISTCMP_MATCH_INORDER);
-  assert(LCompare(reverse,   orginal, unittest_compare) == LLISTCMP_MATCH_REVERSE);
-  assert(LCompare(nonorder,  orginal, unittest_compare) == LLISTCMP_MATCH_NONORDER);
-  assert(LCompare(subset,    orginal, unittest_compare) == LLISTCMP_MATCH_SUBSET);
-  assert(LCompare(orginal,   subset,  unittest_compare) != LLISTCMP_MATCH_SUBSET);
-  assert(LCompare(revsubset, orginal, unittest_compare) == LLISTCMP_MATCH_REVSUBSET);
-  assert(LCompare(included,  orginal, unittest_compare) == LLISTCMP_MATCH_INCLUDED);
-  assert(LCompare(covered,   orginal, unittest_compare) == LLISTCMP_MATCH_COVERED);
-  assert(LCompare(orginal,   covered, unittest_compare) != LLISTCMP_MATCH_COVERED);
-  assert(LCompare(partial,   orginal, unittest_compare) == LLISTCMP_MATCH_PARTIAL);
-  assert(LCompare(nothing,   orginal, unittest_compare) == LLISTCMP_MATCH_NOTHING);
-  assert(LCompare(nothing2,  orginal, unittest_compare) == LLISTCMP_MATCH_NOTHING);
+  for(i = 0; i < 10; i++)
+    {
+      assert(LColumnCount(&column, UNITTEST_BENCH_NODES / 2 + 1, UNITTEST_BENCH_NODES) == UNITTEST_BENCH_NODES / 2 - 1);
+    }
 
-  LRemoveAll(orginal);
-  assert(LCompare(nothing,  orginal, unittest_compare) == LLISTCMP_MATCH_NOTHING);
-  LRemoveAll(nothing);
-  assert(LCompare(nothing,  orginal, unittest_compare) == LLISTCMP_MATCH_NOTHING);
+  printf("column count %d ms (%d lanes)\n", (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC), LCOLUMN_LANES);
 
-  unittest_dispose_all( orginal, reverse, inorder, nonorder, subset,
-      revsubset, included, covered, partial, nothing, nothing2, NULL);
+  LColumnDispose(&column);
+  LDispose(&list);
 }
 
 
-/* ------ Testset 11 - finding ------ */
-static void unittest_testset11( void )
+/* ------ Testset 25 - partition ------ */
+static unsigned unittest_bucket(const lnode_t* node, unsigned user_data)
 {
-  const char* string = "unittest";
-  llist_t * list   = unittest_generate_list( 6,   1, 2, 3, 4, 5, 1);
-  llist_t * list2  = unittest_generate_list( 4,   3, 4, 5, 6);
-  lnode_t * node;
+  return (unsigned)((test_record_t*)node)->value % user_data;
+}
 
-  printf("\nTestset 11 - finding.\n\n");
+static void unittest_testset25( void )
+{
+  llist_t * list  = unittest_generate_list( 10,   0, 1, 2, 3, 4, 5, 6, 7, 8, 9);
+  llist_t * out[4];
+  unsigned  i;
 
-  node = LFindPair( LNext(LFirst(list)), unittest_compare, LLast(list), LLOOP_FORWARD);
-  assert(node != NULL);
-  assert(((test_record_t*)node)->id == 6);
+  printf("\nTestset 25 - partition.\n\n");
 
-  node = LFindPair( LNext(LFirst(list)), unittest_compare, LLast(list), LLOOP_BACKWARD);
-  assert(node != NULL);
-  assert(((test_record_t*)node)->id == 1);
+  out[0] = unittest_generate_list( 1,   100);
+  out[1] = unittest_generate_list( 0 );
+  out[2] = unittest_generate_list( 0 );
+  out[3] = NULL;
 
-  node = LFindPair( LFirst(list), unittest_compare, LFirst(list2), LLOOP_FORWARD);
-  assert(node != NULL);
-  node = LFindPair( LFirst(list), unittest_compare, LLast(list2),  LLOOP_FORWARD);
-  assert(node == NULL);
+  assert(LHashIndexEnable(out[0], offsetof(test_record_t, value), sizeof(int), NULL, NULL) == LLIST_YES);
 
-  node = LFindNode(LLast(list), unittest_filter, 9999, LLOOP_BACKWARD);
-  assert(node == NULL);
+  /* bucket 3 has no list and values % 4 == 3 remain */
+  assert(LPartition(list, unittest_bucket, 4, out, 4) == 8);
 
-  node = LFindNode(LFirst(list), unittest_filter, 1, LLOOP_FORWARD);
-  assert(node == LNext(LFirst(list)));
+  for(i = 0; i < 3; i++)
+    {
+      unittest_show("bucket", out[i]);
+    }
 
-  node = LFindValue( LFirst(list), offsetof(test_record_t, id), -3, sizeof(int), LLOOP_FORWARD);
-  assert(node == NULL);
+  assert(((test_record_t*)LFirst(list))->value == 3 && ((test_record_t*)LLast(list))->value == 7);
+  assert(LCount(list) == 2 && LCount(out[0]) == 4 && LCount(out[1]) == 3 && LCount(out[2]) == 2);
+  assert(((test_record_t*)LFirst(out[0]))->value == 100);
+  assert(((test_record_t*)LGetNode(out[1], 0))->value == 1);
+  assert(((test_record_t*)LGetNode(out[1], 1))->value == 5);
+  assert(((test_record_t*)LGetNode(out[1], 2))->value == 9);
+  assert(((test_record_t*)LLast(out[2]))->value == 6);
 
-  node = LFindValue( LFirst(list), offsetof(test_record_t, id), 3, sizeof(int), LLOOP_FORWARD);
-  assert(((test_record_t*)node)->id == 3);
+  i = 8;
+  assert(((test_record_t*)LLookup(out[0], &i))->id == 9);
 
-  /* modify node 3 data field */
-  ((test_record_t*)node)->string = (char*)string;
+  /* all into first bucket, nothing into none */
+  assert(LPartition(list, unittest_bucket, 1, out, 1) == 2);
+  assert(LPartition(out[1], unittest_bucket, 1, out, 0) == 0);
+  assert(LCount(list) == 0 && LCount(out[0]) == 6);
 
-  node = LFindData( LFirst(list), offsetof(test_record_t, string), (char*)string, strlen(string)+1, LLOOP_FORWARD);
-  assert(((test_record_t*)node)->id == 3);
+  unittest_dispose_all(list, out[0], out[1], out[2], NULL);
+}
 
-  node = LFindData( LFirst(list), offsetof(test_record_t, string), "nonsense", 0, LLOOP_FORWARD);
-  assert(node == NULL);
 
-  node = LFindData( LFirst(list), offsetof(test_record_t, string), "unittest", 0, LLOOP_FORWARD);
-  assert(((test_record_t*)node)->id == 3);
+/* ------ Testset 26 - clone ------ */
+static void unittest_testset26( void )
+{
+  llist_t * list  = unittest_generate_list( 4,   1, 2, 3, 4);
+  llist_t * clone = unittest_generate_list( 1,   9);
+  llist_t * check = unittest_generate_list( 5,   9, 1, 2, 3, 4);
+  test_record_t * record;
+  clock_t   start_time;
+  unsigned  i;
+  int       value = 3;
 
-  node = LFindData( node, offsetof(test_record_t, string), NULL, 0, LLOOP_BACKWARD);
-  assert(((test_record_t*)node)->id != 3);
+  printf("\nTestset 26 - clone.\n\n");
 
-  node = LFindData( LFirst(list), offsetof(test_record_t, string), NULL, 0, LLOOP_FORWARD);
-  assert(LIsFirst(node));
-  assert(!LIsLast(node));
+  assert(LHashIndexEnable(clone, offsetof(test_record_t, value), sizeof(int), NULL, NULL) == LLIST_YES);
 
-  LRemoveAll(list2);
-  assert(LIsFirst(list2->first)); /* NULL */
-  assert(LIsLast(list2->first));  /* NULL */
+  LFilterClone(list, &clone, NULL, 0);
+  unittest_show("clone", clone);
+  assert(LCompare(clone, check, unittest_compare, LLISTCMP_MATCH_INORDER) == LLISTCMP_MATCH_INORDER);
+  assert(LPrev(LFirst(clone)) == NULL && LNext(LLast(clone)) == NULL);
+  assert(LNext(LFirst(clone)) != LFirst(list));
+  assert(((test_record_t*)LLookup(clone, &value))->id == 3);
 
-  unittest_dispose_all(list, list2, NULL);
-}
+  unittest_dispose_all(list, clone, check, NULL);
 
-/* ------ Testset 12 - sorting ------ */
-static void unittest_testset12( void )
-{
-  test_record_t * record1 = NULL;
-  test_record_t * record2 = NULL;
-  test_record_t * record3 = NULL;
-  llist_t * list = unittest_generate_list( 4, 1, 22, 333, 4444);
+  /* against cloning by callback */
+  list = LInit(sizeof(test_record_t), NULL, NULL);
 
-  printf("\nTestset 12 - sorting.\n\n");
+  for(i = 0; i < UNITTEST_BENCH_NODES; i++)
+    {
+      record = (test_record_t*)LCreateLast(list);
+      record->id    = (int)i;
+      record->value = (int)i;
+    }
 
-  unittest_show("unsorted", list);
-  LSort(list, unittest_compare);
+  clone = NULL;
+  start_time = clock();
+  LFilterClone(list, &clone, unittest_clone, 0);
+  printf("clone by callback %d ms\n", (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC));
+  LDispose(&clone);
 
-  unittest_show("sorted", list);
-  LSort(list, unittest_compare);
+  start_time = clock();
+  LFilterClone(list, &clone, NULL, 0);
+  printf("clone as chain %d ms\n", (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC));
 
-  record1 = (test_record_t*)LCreateBefore(list, LLast(list));
-  record1->id = 5;
-  record1->value = 1;
+  assert(LCount(clone) == UNITTEST_BENCH_NODES);
+  assert(LVerify(clone, unittest_compare) == LLIST_YES);
 
-  record1 = (test_record_t*)LCreateAfter(list, LFirst(list));
-  record1->id = 6;
-  record1->value = 4444;
+  unittest_dispose_all(list, clone, NULL);
+}
 
-  record1 = (test_record_t*)LCreateAfter(list, LFirst(list));
-  record1->id = 7;
-  record1->value = 333;
-  assert(list->count == 7);
 
-  assert(LVerify(list, unittest_compare) == LLIST_NO);
-  unittest_show("unsorted", list);
+/* ------ Testset 27 - known order ------ */
+static unsigned unittest_compares;
 
-  LSort(list, unittest_compare);
-  unittest_show("sorted", list);
+static signed int unittest_compare_counted(const lnode_t* node1, const lnode_t* node2)
+{
+  unittest_compares++;
+  return unittest_compare(node1, node2);
+}
 
-  LShuffle(list, NULL);
-  unittest_show("unsorted", list);
+static void unittest_testset27( void )
+{
+  llist_t * list  = unittest_generate_list( 6,   5, 3, 8, 1, 9, 2);
+  llist_t * split;
+  test_record_t * record;
+  clock_t   start_time;
+  unsigned  i;
 
-  LReverse(list);
-  LSort(list, unittest_compare);
-  unittest_show("sorted", list);
+  printf("\nTestset 27 - known order.\n\n");
 
-  LVerify(list, unittest_compare);
+  assert(LVerify(list, unittest_compare_counted) == LLIST_NO);
+  LSort(list, unittest_compare_counted);
 
-  record1 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
-  record1->id = 801;
-  record1->value = 22;
-  LAttachSorted(list, (lnode_t*)record1, unittest_compare, LLOOP_FORWARD);
-  assert(list->count == 8);
+  /* verified without compares */
+  unittest_compares = 0;
+  assert(LVerify(list, unittest_compare_counted) == LLIST_YES);
+  LSort(list, unittest_compare_counted);
+  assert(unittest_compares == 0);
 
-  record2 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
-  record2->id = 802;
-  record2->value = 22;
-  LAttachSorted(list, (lnode_t*)record2, unittest_compare, LLOOP_FORWARD);
-  assert(LPrev(record1) == (lnode_t*)record2);
+  /* other compare function is verified */
+  assert(LVerify(list, unittest_compare) == LLIST_YES);
+  assert(LVerify(list, unittest_compare_counted) == LLIST_YES && unittest_compares > 0);
 
-  record3 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
-  record3->id = 803;
-  record3->value = 22;
-  LAttachSorted(list, (lnode_t*)record3, unittest_compare, LLOOP_BACKWARD);
-  assert(LPrev(LPrev(record3)) == (lnode_t*)record1);
+  /* removal and sorted attach keep the order */
+  LRemove(list, LFirst(list));
+  record = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
+  record->value = 4;
+  LAttachSorted(list, (lnode_t*)record, unittest_compare_counted, LLOOP_FORWARD);
+  unittest_compares = 0;
+  assert(LVerify(list, unittest_compare_counted) == LLIST_YES && unittest_compares == 0);
+
+  /* both parts of split are in order */
+  split = LSplit(list, LGetNode(list, 3));
+  assert(LVerify(split, unittest_compare_counted) == LLIST_YES && unittest_compares == 0);
+  LJoin(list, &split);
+  assert(LVerify(list, unittest_compare_counted) == LLIST_YES && unittest_compares > 0);
+  unittest_show("list", list);
+
+  /* unsorted attach and changed keys break the order */
+  record = (test_record_t*)LCreateFirst(list);
+  record->value = 99;
+  assert(LVerify(list, unittest_compare_counted) == LLIST_NO);
+  LSort(list, unittest_compare_counted);
+  ((test_record_t*)LFirst(list))->value = 100;
+  LSortInvalidate(list);
+  assert(LVerify(list, unittest_compare_counted) == LLIST_NO);
+  LFilterOperate(list, NULL, 0, unittest_operate, 0);
+  assert(list->sortedby == NULL);
 
-  record1 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
-  record1->id = 804;
-  record1->value = 0;
-  LAttachSorted(list, (lnode_t*)record1, unittest_compare, LLOOP_BACKWARD);
-  assert(LFirst(list) == (lnode_t*)record1);
+  unittest_dispose_all(list, NULL);
 
-  record1 = (test_record_t*)LAlloc(sizeof(test_record_t), LLIST_NO);
-  record1->id = 805;
-  record1->value = 9999;
-  LAttachSorted(list, (lnode_t*)record1, unittest_compare, LLOOP_FORWARD);
-  assert(LLast(list) == (lnode_t*)record1);
+  /* repeated verify and append */
+  list = LInit(sizeof(test_record_t), NULL, NULL);
 
-  LVerify(list, unittest_compare);
-  unittest_show("sorted", list);
+  for(i = 0; i < UNITTEST_BENCH_NODES; i++)
+    {
+      record = (test_record_t*)LCreateLast(list);
+      record->value = (int)i;
+    }
 
-  LReverse(list);
-  LVerify(list, unittest_compare);
+  start_time = clock();
+
+  for(i = 0; i < 100; i++)
+    {
+      assert(LVerify(list, unittest_compare) == LLIST_YES);
+      LSort(list, unittest_compare);
+    }
+
+  printf("verify and sort 100 times %d ms\n", (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC));
 
   unittest_dispose_all(list, NULL);
 }
 
 
-/* ------ Testset 13 - expanded nodes ------ */
-static void unittest_testset13( void )
+/* ------ Testset 28 - adaptive sort ------ */
+static void unittest_sort_check( llist_t * list, unsigned count )
 {
-  typedef struct
+  test_record_t * prev = NULL;
+  unsigned        n    = 0;
+
+  LInitFor(test_record_t*, record, list)
     {
-      int id;
-      int value;
-      char padding;
-    } any_struct_t;
+      /* equal values keep the order of ids */
+      assert((test_record_t*)LPrev(record) == prev);
+      assert(!prev || prev->value < record->value ||
+             (prev->value == record->value && prev->id < record->id));
+      prev = record;
+      n++;
+    }
 
-  llist_t * list = LInit(0, LExpandedDealloc, NULL);
-  any_struct_t * object = NULL;
-  lnode_t * node = NULL;
-  unsigned size;
-  unsigned offset;
+  assert(n == count && LCount(list) == count && (test_record_t*)LLast(list) == prev);
+}
 
-  printf("\nTestset 12 - expanded size.\n\n");
+static void unittest_testset28( void )
+{
+  llist_t * list  = unittest_generate_list( 13,   5, 6, 2, 7, 9, 6, 2, 6, 8, 3, 1, 4, 5);
+  test_record_t * record;
+  clock_t   start_time;
+  unsigned  count;
+  unsigned  i;
+  int       value = 7;
 
-  size   = sizeof(any_struct_t) + /* test */ 1;
-  offset = LExpandedSize( &size );
-  assert( size != sizeof(any_struct_t) );
+  printf("\nTestset 28 - adaptive sort.\n\n");
 
-  object = (any_struct_t*)os_block_alloc_and_clear( size );
-  object->id    = 1;
-  object->value = 10;
-  LAttachLast(list, LCastNode( (void*)object, offset ));
+  assert(LHashIndexEnable(list, offsetof(test_record_t, value), sizeof(int), NULL, NULL) == LLIST_YES);
+  LSort(list, unittest_compare);
+  unittest_show("sorted", list);
+  unittest_sort_check(list, 13);
+  assert(((test_record_t*)LLookup(list, &value))->id == 4);
+  unittest_dispose_all(list, NULL);
 
-  object = (any_struct_t*)os_block_alloc_and_clear( size + 1);
-  object->id    = 2;
-  object->value = 20;
-  LAttachLast(list, LCastNode( (void*)object, offset ));
+  /* random, reversed, sawtooth and few distinct values */
+  for(count = 1; count < 3000; count = count * 3 + 1)
+    {
+      for(i = 0; i < 4; i++)
+        {
+          unsigned n;
 
-  object = (any_struct_t*)os_block_alloc_and_clear( size + 2);
-  object->id    = 3;
-  object->value = 30;
-  LAttachLast(list, LCastNode( (void*)object, offset ));
+          list = LInit(sizeof(test_record_t), NULL, NULL);
+          LShuffleSeed(count + i);
 
-  object = (any_struct_t*)os_block_alloc_and_clear( size + 3);
-  object->id    = 4;
-  object->value = 40;
-  LAttachLast(list, LCastNode( (void*)object, offset ));
+          for(n = 0; n < count; n++)
+            {
+              record = (test_record_t*)LCreateLast(list);
+              record->id    = (int)n;
+              record->value = (i == 0 ? (int)(LShuffleRandom() % 1000) :
+                               i == 1 ? (int)(count - n) :
+                               i == 2 ? (int)(n % 50) : (int)(LShuffleRandom() % 3));
+            }
 
-  assert(LCount(list) == 4);
-  printf("List with %d expanded nodes.\n", LCount(list)); 
-  node = LFirst(list);
+          LSort(list, unittest_compare);
+          unittest_sort_check(list, count);
+          unittest_dispose_all(list, NULL);
+        }
+    }
 
-  while(node)
+  /* sorted list with appended nodes */
+  list = LInit(sizeof(test_record_t), NULL, NULL);
+  LShuffleSeed(28);
+
+  for(i = 0; i < UNITTEST_BENCH_NODES; i++)
     {
-      object = LCastObject(node);
-      printf("object id %d value = %d\n", object->id, object->value);
-      node = LNext(node);
+      record = (test_record_t*)LCreateLast(list);
+      record->id    = (int)i;
+      record->value = (int)i * 4;
     }
 
-  assert(LCount(list) == 4);
-  LRemoveAll(list);
-  assert(LCount(list) == 0);
+  for(i = 0; i < 500; i++)
+    {
+      record = (test_record_t*)LCreateLast(list);
+      record->id    = (int)(UNITTEST_BENCH_NODES + i);
+      record->value = (int)(LShuffleRandom() % (UNITTEST_BENCH_NODES * 4));
+    }
+
+  unittest_compares = 0;
+  start_time = clock();
+  LSort(list, unittest_compare_counted);
+  printf("sort of %d sorted and 500 appended nodes %d ms, %u compares\n", UNITTEST_BENCH_NODES,
+    (int)((clock() - start_time) * 1000 / CLOCKS_PER_SEC), unittest_compares);
+
+  unittest_sort_check(list, UNITTEST_BENCH_NODES + 500);
+  assert(unittest_compares < UNITTEST_BENCH_NODES + 500 * 64);
 
   unittest_dispose_all(list, NULL);
 }
@@ -3195,6 +7128,51 @@ int main(void)
   /* Testset 13 - expanded nodes */
   unittest_testset13();
 
+  /* Testset 14 - sorted index */
+  unittest_testset14();
+
+  /* Testset 15 - key hash index */
+  unittest_testset15();
+
+  /* Testset 16 - compact */
+  unittest_testset16();
+
+  /* Testset 17 - prefetch benchmark */
+  unittest_testset17();
+
+  /* Testset 18 - parallel filtering */
+  unittest_testset18();
+
+  /* Testset 19 - create many */
+  unittest_testset19();
+
+  /* Testset 20 - range splice */
+  unittest_testset20();
+
+  /* Testset 21 - set operations */
+  unittest_testset21();
+
+  /* Testset 22 - k-way merge */
+  unittest_testset22();
+
+  /* Testset 23 - relocatable image */
+  unittest_testset23();
+
+  /* Testset 24 - column scanning */
+  unittest_testset24();
+
+  /* Testset 25 - partition */
+  unittest_testset25();
+
+  /* Testset 26 - clone */
+  unittest_testset26();
+
+  /* Testset 27 - known order */
+  unittest_testset27();
+
+  /* Testset 28 - adaptive sort */
+  unittest_testset28();
+
   end_time = clock();
 
   printf("\nTime %d ms", end_time - start_time);
@@ -3203,4 +7181,4 @@ int main(void)
   return 0;
 }
 
-#endif /* UNITTEST_MAIN */
+#endif /* LLIST_UNITTEST */
@@ -103,11 +103,21 @@ struct lnode_t
  *  - NodeClone_f can return NULL for filtering purposes.
  *  - NodeClear_f can return NULL if node also became deallocated.
  *    (recommended to return same node pointer, since memory pool can be in use)
+ *  - NodeHash_f must return same value for all nodes NodeCmp_f finds equal.
+ *  - NodeRelocate_f is called after node content was copied to new place,
+ *    old node is still readable but deallocated after relocation is done.
+ *  - NodeWorkers_f must run Task for each of the tasks (in any threads)
+ *    and return only after all of them are finished.
  */
 typedef lnode_t *  (*NodeClear_f) ( lnode_t * node );
 typedef lnode_t *  (*NodeClone_f) ( const lnode_t * node,  unsigned user_data );
 typedef lbool_e    (*NodeFilter_f)( const lnode_t * node,  unsigned user_data );
+typedef unsigned   (*NodeBucket_f)( const lnode_t * node,  unsigned user_data );
 typedef signed int (*NodeCmp_f)   ( const lnode_t * node1, const lnode_t * node2 );
+typedef unsigned   (*NodeHash_f)  ( const lnode_t * node );
+typedef void       (*NodeRelocate_f)( lnode_t * node, const lnode_t * old_node );
+typedef void       (*NodeTask_f)  ( void * task );
+typedef void       (*NodeWorkers_f)( NodeTask_f Task, void * tasks[], unsigned count );
 
 
 /*
@@ -127,9 +137,63 @@ typedef struct
    */
   void * memorypool;
 
+  /*
+   *  Optional sorted list index (see LSortIndexEnable).
+   */
+  void * sortindex;
+
+  /*
+   *  Optional key hash index (see LHashIndexEnable).
+   */
+  void * hashindex;
+
+  /*
+   *  Changed by every change of nodes in list (see lcolumn_t).
+   */
+  unsigned version;
+
+  /*
+   *  Compare function by which list is known to be in order (see LVerify).
+   */
+  NodeCmp_f sortedby;
+
 } llist_t;
 
 
+/*
+ *  (limage_t*) -  Header of relocatable list image (see LImageWrite),
+ *  followed by the nodes of list.
+ */
+#define LIMAGE_MAGIC  0x4C494D47u   /* "LIMG" */
+
+typedef struct
+{
+  unsigned  magic;
+  unsigned  link_size;       /* Size of pointer when written  */
+  unsigned  node_size;
+  unsigned  count;
+  size_t    size;            /* Size of image in bytes        */
+
+} limage_t;
+
+
+/*
+ *  (lcolumn_t) -  Column of integer member of nodes in list order, which
+ *  is scanned instead of nodes (see LColumnSetup, can be static object).
+ */
+typedef struct
+{
+  llist_t *   list;
+  unsigned    offset;        /* Offset of int member in node  */
+  unsigned    version;       /* List version of column        */
+  unsigned    count;
+  unsigned    space;         /* Allocated entries             */
+  int *       keys;
+  lnode_t **  nodes;
+
+} lcolumn_t;
+
+
 /* --------------------------------------------------------------- */
 
 /*
@@ -173,7 +237,11 @@ llist_t * LInit( unsigned node_size, NodeClear_f NodeClear, void * memorypool );
   staticlist.clear_func = _NodeClear;                 \
   staticlist.node_size  = _node_size;                 \
   staticlist.count      = 0;                          \
-  staticlist.memorypool = NULL;
+  staticlist.memorypool = NULL;                       \
+  staticlist.sortindex  = NULL;                       \
+  staticlist.hashindex  = NULL;                       \
+  staticlist.version    = 0;                          \
+  staticlist.sortedby   = NULL;
 
 
 /*
@@ -186,7 +254,11 @@ llist_t * LInit( unsigned node_size, NodeClear_f NodeClear, void * memorypool );
   ((llist_t*)_list)->clear_func = ((llist_t*)_from_list)->free_func; \
   ((llist_t*)_list)->node_size  = ((llist_t*)_from_list)->node_size; \
   ((llist_t*)_list)->count      = 0;                                 \
-  ((llist_t*)_list)->memorypool = ((llist_t*)_from_list)->memorypool;
+  ((llist_t*)_list)->memorypool = ((llist_t*)_from_list)->memorypool; \
+  ((llist_t*)_list)->sortindex  = NULL;                              \
+  ((llist_t*)_list)->hashindex  = NULL;                              \
+  ((llist_t*)_list)->version    = 0;                                 \
+  ((llist_t*)_list)->sortedby   = NULL;
 
 
 /*
@@ -199,6 +271,13 @@ lnode_t *  LCreateBefore( llist_t * list, lnode_t * before );
 lnode_t *  LCreateAfter(  llist_t * list, lnode_t * after  );
 
 
+/*
+ *  Create count nodes at once after given node, or to the beginning of list
+ *  if NULL (use LLast(list) to append). Returns the first created node.
+ */
+lnode_t *  LCreateMany(   llist_t * list, unsigned count, lnode_t * after );
+
+
 /*
  *  Get list and node object information.
  *  Parameters may not be NULLs, but NULL can be returned if no node.
@@ -213,14 +292,32 @@ lnode_t *  LCreateAfter(  llist_t * list, lnode_t * after  );
 #define    LIsLast(  node )  (!(node)||!(node)->next)
 
 
+/*
+ *  Software prefetch of nodes ahead in traversal loops, to hide the
+ *  cache misses of scattered nodes behind the work done per node.
+ *  LLIST_PREFETCH_DISTANCE is the amount of nodes fetched ahead by
+ *  library loops calling back per node (0 disables), loop macros fetch
+ *  the next node. Loops with little work per node gain nothing.
+ */
+#ifndef LLIST_PREFETCH_DISTANCE
+#define LLIST_PREFETCH_DISTANCE  2
+#endif
+
+#if LLIST_PREFETCH_DISTANCE > 0 && defined __GNUC__
+#define    LPrefetch( node )  __builtin_prefetch(node)
+#else
+#define    LPrefetch( node )  ((void)0)
+#endif
+
+
 /*
  *  Forward and backward loops for linked lists.
  */
 #define    LFor( type, node, list ) \
-    for( node = (type)LFirst(list); node != NULL; node = (type)LNext(node) )
+    for( node = (type)LFirst(list); node != NULL && (LPrefetch(LNext(node)), 1); node = (type)LNext(node) )
 
 #define    LBack( type, node, list ) \
-    for( node = (type)LLast(list); node != NULL; node = (type)LPrev(node) )
+    for( node = (type)LLast(list); node != NULL && (LPrefetch(LPrev(node)), 1); node = (type)LPrev(node) )
 
 
 /*
@@ -359,6 +456,37 @@ void       LAttachAfter(  llist_t * list, lnode_t * node, lnode_t * after  );
 void       LAttachSorted( llist_t * list, lnode_t * node, NodeCmp_f NodeCmp, lloop_e direction );
 
 
+/*
+ *  Optional index for sorted list, which makes LAttachSorted and LFindSorted
+ *  O(log n) operations when used with the same compare function (skip list).
+ *  - Enabling fails (LLIST_NO) if list is not in order by given function.
+ *  - Index is kept in sync by LAttachSorted and by detach and remove functions.
+ *  - Any other attach or reordering disables the index, as well as attaching
+ *    sorted with other compare function. Nodes must not be modified so that
+ *    their order would change while index is enabled.
+ */
+lbool_e    LSortIndexEnable(  llist_t * list, NodeCmp_f NodeCmp );
+void       LSortIndexDisable( llist_t * list );
+lnode_t *  LFindSorted(       llist_t * list, NodeCmp_f NodeCmp, lnode_t * match_node );
+
+
+/*
+ *  Optional key hash index for O(1) lookups of nodes by key, either
+ *  - member value of 'size' bytes at 'offset' of node (NodeHash NULL), where
+ *    LLookup key is pointer to value, e.g. LLookup(list, &id), or
+ *  - NodeHash and NodeCmp functions, where LLookup key is a node to match.
+ *  Index is kept in sync by attach, detach and remove functions, but nodes
+ *  created by LCreate* are added only by LHashIndexAdd after key is set.
+ *  Node key must not be modified while indexed (remove, modify and add).
+ */
+lbool_e    LHashIndexEnable(  llist_t * list, unsigned offset, unsigned size,
+                                              NodeHash_f NodeHash, NodeCmp_f NodeCmp );
+void       LHashIndexDisable( llist_t * list );
+void       LHashIndexAdd(     llist_t * list, lnode_t * node );
+void       LHashIndexRemove(  llist_t * list, lnode_t * node );
+lnode_t *  LLookup(           llist_t * list, const void * key );
+
+
 /*
  *  Deallocate all detached nodes by first calling given function and then
  *  auto-dealloc from OS or memory pool.
@@ -391,6 +519,18 @@ llist_t *  LSplit( llist_t * list, lnode_t *  node );
 void       LJoin(  llist_t * list, llist_t ** other );
 
 
+/*
+ *  Move range of nodes (from first to last) from src list after given node in
+ *  dst list (or to the beginning, if NULL). Constant time when count of the
+ *  range is given or lists are same; with 0 count the range is counted.
+ *  (Key hash indices need to visit each node in any case)
+ *  When dst and src are the same list, after must not be a node of the range
+ *  (asserted in debug builds).
+ */
+void       LSpliceRange( llist_t * dst, lnode_t * after, llist_t * src,
+                         lnode_t * first, lnode_t * last, unsigned count );
+
+
 /*
  *  Verify that list contains a certain node.
  */
@@ -406,6 +546,15 @@ lbool_e    LContains( llist_t * list, lnode_t * node );
 llistcmp_e LCompare( llist_t * list, llist_t * other, NodeCmp_f NodeCmp, unsigned limit_mask );
 
 
+/*
+ *  Compare like above, but non-ordered matches (nonorder, included, covered) are
+ *  counted by a temporary hash table in linear time instead of comparing every
+ *  node pair. Falls back to LCompare behaviour if hash table cannot be allocated.
+ */
+llistcmp_e LCompareHashed( llist_t * list, llist_t * other, NodeCmp_f NodeCmp,
+                           NodeHash_f NodeHash, unsigned limit_mask );
+
+
 /*
  *  Find single node which content match to other node or given criteria.
  */
@@ -429,25 +578,150 @@ void       LFilterClone(  llist_t * list, llist_t ** other, NodeClone_f  NodeClo
 void       LFilterMove(   llist_t * list, llist_t ** other, NodeFilter_f NodeFilter, unsigned user_data );
 
 
+/*
+ *  Move nodes into n lists by bucket index given by callback, in one pass.
+ *  Nodes are attached as last (in same order as in list), and nodes with
+ *  bucket index n or above (or NULL list) remain in list. No allocations.
+ *  Returns the amount of nodes moved.
+ */
+unsigned   LPartition(    llist_t * list, NodeBucket_f NodeBucket, unsigned user_data,
+                                          llist_t * out[], unsigned n );
+
+
+/*
+ *  Parallel filtering with given worker pool. List is split into given amount
+ *  of segments, which are filtered as separate tasks, and the results are merged
+ *  (in same order as serial functions). Filter and operate callbacks must be
+ *  thread safe and access only the given node. Serial function is used if
+ *  no worker pool, or less than 2 segments or list has less nodes than segments.
+ */
+unsigned   LParallelFilterCount(   llist_t * list, NodeFilter_f NodeFilter,  unsigned user_data,
+                                   NodeWorkers_f Workers, unsigned segments );
+unsigned   LParallelFilterRemove(  llist_t * list, NodeFilter_f NodeFilter,  unsigned user_data,
+                                   NodeWorkers_f Workers, unsigned segments );
+unsigned   LParallelFilterOperate( llist_t * list, NodeFilter_f NodeFilter,  unsigned user_data_filter,
+                                                   NodeFilter_f NodeOperate, unsigned user_data_operate,
+                                   NodeWorkers_f Workers, unsigned segments );
+void       LParallelFilterMove(    llist_t * list, llist_t ** other, NodeFilter_f NodeFilter, unsigned user_data,
+                                   NodeWorkers_f Workers, unsigned segments );
+
+
 /*
  *  Remove duplicate nodes based on compare function from given direction.
  */
 void       LUnique( llist_t * list, NodeCmp_f NodeCmp, lloop_e direction );
 
 
+/*
+ *  Remove duplicates like above, but in one pass using temporary hash table
+ *  (allocated from list memory pool if in use). Falls back to LUnique if
+ *  hash table cannot be allocated.
+ */
+void       LUniqueHashed( llist_t * list, NodeHash_f NodeHash, NodeCmp_f NodeCmp, lloop_e direction );
+
+
 /*
  *  Change the order of items into reverse or random.
+ *  Shuffle uses internal randomizer if NULL given, which can be seeded
+ *  for repeatable order. Given randomizer should cover the list length.
  */
 void       LShuffle( llist_t * list, int (*randomizer)(void) );
+void       LShuffleSeed( unsigned seed );
 void       LReverse( llist_t * list );
 
 
+/*
+ *  Relocate nodes into newly allocated memory in list order, so that list
+ *  traversal accesses memory sequentially again after heavy reordering.
+ *  List does not know how its nodes were allocated, thus caller must make
+ *  sure that all nodes are default size nodes of the list (no LAlloc'ed
+ *  nor expanded nodes). LLIST_NO is returned for lists without default
+ *  node size, and if new nodes could not be allocated (list unchanged).
+ *  NodeRelocate can be given to fix any references to relocated nodes.
+ */
+lbool_e    LCompact( llist_t * list, NodeRelocate_f NodeRelocate );
+
+
+/*
+ *  Relocatable image of list for persistence, e.g. file mapped with mmap.
+ *  Image is header and nodes of default size in list order, where links are
+ *  byte offsets from the beginning of image (0 for NULL), thus it is valid at
+ *  any address. Other node content is copied as such (it should hold no
+ *  pointers). LImageSize gives needed bytes, or 0 if list can not be written
+ *  (node size not multiple of pointer size, or image would not fit in size_t).
+ *  Image must be aligned to pointer size.
+ *
+ *  Image can be traversed as such through offsets (LImageFor), or loaded
+ *  into empty list, which relinks the nodes in place in one pass (image is
+ *  then no more relocatable). Loaded nodes are in image memory, so detach
+ *  them (LDetachAll) instead of removing, before image is released.
+ *  LLIST_NO returned if image is too small, or not valid for this build.
+ */
+size_t     LImageSize(  llist_t * list );
+lbool_e    LImageWrite( llist_t * list, void * image, size_t size );
+lbool_e    LImageLoad(  llist_t * list, void * image, size_t size );
+
+#define    LImageCount( image )        (((limage_t*)(image))->count)
+#define    LImageFirst( image )        (LImageCount(image) ? (lnode_t*)((char*)(image) + sizeof(limage_t)) : NULL)
+#define    LImageNext( image, node )   ((node)->next ? (lnode_t*)((char*)(image) + (size_t)(node)->next) : NULL)
+#define    LImagePrev( image, node )   ((node)->prev ? (lnode_t*)((char*)(image) + (size_t)(node)->prev) : NULL)
+
+#define    LImageFor( type, node, image ) \
+    for( node = (type)LImageFirst(image); node != NULL; node = (type)LImageNext(image, (lnode_t*)(node)) )
+
+
+/*
+ *  Column of int member (at offset of node) for repeated scanning. Values
+ *  are copied into contiguous array, which is compared several values at
+ *  a time (SSE2/AVX2 when compiled for those), along with array of nodes.
+ *  Column is rebuilt on next scan if the list was changed since (version),
+ *  but changes of member values must be told by LColumnInvalidate.
+ *  Count returns the amount of nodes with low <= value <= high, and Find
+ *  returns next such node from position (0 for first), which is updated
+ *  for the next call (NULL returned when no more nodes).
+ */
+void       LColumnSetup(   lcolumn_t * column, llist_t * list, unsigned offset );
+void       LColumnDispose( lcolumn_t * column );
+unsigned   LColumnCount(   lcolumn_t * column, int low, int high );
+lnode_t *  LColumnFind(    lcolumn_t * column, int low, int high, unsigned * position );
+
+#define    LColumnInvalidate( column )   ((column)->version = (column)->list->version - 1)
+
+
 /*
  *  Sort linked list with given compare function if verified not to be sorted.
+ *  Sort is stable merge sort of runs already in order (O(n) for sorted list,
+ *  and about n + k log k compares for k nodes added into sorted list).
+ *  List remembers the compare function it was verified or sorted with, thus
+ *  both return at once until order may be broken: removals, LAttachSorted
+ *  and LSplit keep the order, other attach/create/move/swap calls and
+ *  LFilterOperate forget it. Changes of node keys must be told by
+ *  LSortInvalidate.
  */
 lbool_e    LVerify(  llist_t * list, NodeCmp_f NodeCmp );
 void       LSort(    llist_t * list, NodeCmp_f NodeCmp );
 
+#define    LSortInvalidate( list )   ((list)->sortedby = NULL)
+
+
+/*
+ *  Set operations for lists sorted with given compare function, in one pass.
+ *  Result is left into list, and nodes not in result are moved into other
+ *  (both lists remain sorted, no nodes are allocated or deallocated).
+ */
+void       LSetUnion(     llist_t * list, llist_t * other, NodeCmp_f NodeCmp );
+void       LSetIntersect( llist_t * list, llist_t * other, NodeCmp_f NodeCmp );
+void       LSetDiff(      llist_t * list, llist_t * other, NodeCmp_f NodeCmp );
+void       LSetSymDiff(   llist_t * list, llist_t * other, NodeCmp_f NodeCmp );
+
+
+/*
+ *  Merge k lists sorted with given compare function into the first list
+ *  in O(n log k) compares, by relinking nodes (other lists are emptied).
+ *  Equal nodes keep the order of lists.
+ */
+void       LMergeK( llist_t * lists[], unsigned k, NodeCmp_f NodeCmp );
+
 
 /* --------------------------------------------------------------- */
 
@@ -522,7 +796,8 @@ typedef struct { lnode_t* link[2]; } llink_t;
 #define    LIsLoopHead( node, direction )  (!(node)||!((llink_t*)node)->link[LLOOPBACKWARD-direction])
 
 #define    LLoop( type, node, list, direction ) \
-    for( node = (type)LLoopHead(list, direction); node; node = (type)LLoopNext(node, direction) )
+    for( node = (type)LLoopHead(list, direction); node && (LPrefetch(LLoopNext(node, direction)), 1); \
+         node = (type)LLoopNext(node, direction) )
 
 
 /*
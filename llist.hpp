@@ -0,0 +1,737 @@
+/*
+ *  General Linked List C++ Template Header
+ *
+ */
+
+#ifndef LLIST_HPP
+#define LLIST_HPP
+
+
+#include <cstddef>
+#include <iterator>
+#include "llist.h"
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Type safe C++ wrapper for linked list library (C++11).
+ *
+ *  Wrapper is a view over llist_t, which holds no other data, thus
+ *  same list can be handled both with this template and with llist.h
+ *  functions. Objects are intrusive: either they begin with LLIST_NODE
+ *  fields (llist<T>), or they have lnode_t member (llist<T, &T::link>).
+ *
+ *  Algorithms take comparators and predicates as template parameters
+ *  (functions objects or lambdas), thus they are inlined and there is
+ *  no indirect call per compare as with NodeCmp_f callbacks.
+ *  Comparators are "less than" functions as in STL.
+ *
+ *  Nodes are linked and unlinked by library functions, so that optional
+ *  indices of the list are kept in sync. Wrapper never allocates nor
+ *  deallocates objects: removing functions take dispose function object.
+ *
+ */
+
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Placement of node fields in object: lnode_t member, or
+ *  LLIST_NODE fields in the beginning of object (no member).
+ */
+template <typename T, lnode_t T::*Link, bool Member = (Link != nullptr)>
+struct llist_link
+{
+  static lnode_t * node( T * object )
+    {
+      return &(object->*Link);
+    }
+
+  static std::size_t offset( void )
+    {
+      return reinterpret_cast<std::size_t>(&(reinterpret_cast<T*>(16)->*Link)) - 16;
+    }
+};
+
+template <typename T, lnode_t T::*Link>
+struct llist_link<T, Link, false>
+{
+  static lnode_t * node( T * object )
+    {
+      return reinterpret_cast<lnode_t*>(object);
+    }
+
+  static std::size_t offset( void )
+    {
+      return 0;
+    }
+};
+
+
+template <typename T, lnode_t T::*Link = nullptr>
+class llist
+{
+public:
+
+  /*
+   *  Conversions between objects and nodes.
+   */
+  static lnode_t * node( T * object )
+    {
+      return llist_link<T, Link>::node(object);
+    }
+
+  static T * object( lnode_t * node )
+    {
+      return node ? reinterpret_cast<T*>(reinterpret_cast<char*>(node) - llist_link<T, Link>::offset()) : nullptr;
+    }
+
+
+  /*
+   *  Bidirectional iterator (end() is NULL node).
+   */
+  class iterator
+  {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef T                               value_type;
+    typedef std::ptrdiff_t                  difference_type;
+    typedef T *                             pointer;
+    typedef T &                             reference;
+
+    iterator( llist_t * list, lnode_t * node ) : list_(list), node_(node) {}
+
+    reference  operator*()  const { return *object(node_); }
+    pointer    operator->() const { return object(node_); }
+
+    iterator & operator++()    { node_ = node_->next; return *this; }
+    iterator & operator--()    { node_ = (node_ ? node_->prev : list_->last); return *this; }
+    iterator   operator++(int) { iterator it = *this; ++*this; return it; }
+    iterator   operator--(int) { iterator it = *this; --*this; return it; }
+
+    bool operator==( const iterator & other ) const { return node_ == other.node_; }
+    bool operator!=( const iterator & other ) const { return node_ != other.node_; }
+
+    lnode_t *  c_node() const { return node_; }
+
+  private:
+    llist_t * list_;
+    lnode_t * node_;
+  };
+
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+
+
+  explicit llist( llist_t * list ) : list_(list) {}
+
+  llist_t *  c_list() const { return list_; }
+
+  iterator   begin()  const { return iterator(list_, list_->first); }
+  iterator   end()    const { return iterator(list_, nullptr); }
+
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend()   const { return reverse_iterator(begin()); }
+
+  unsigned   size()   const { return LCount(list_); }
+  bool       empty()  const { return !list_->first; }
+
+  T *        front()  const { return object(list_->first); }
+  T *        back()   const { return object(list_->last); }
+
+
+  /*
+   *  Attach and detach objects (objects are not allocated or deallocated).
+   */
+  void push_back( T & item )
+    {
+      lnode_t * link = node(&item);
+      link->next = link->prev = nullptr;
+      LAttachLast(list_, link);
+    }
+
+  void push_front( T & item )
+    {
+      lnode_t * link = node(&item);
+      link->next = link->prev = nullptr;
+      LAttachFirst(list_, link);
+    }
+
+  iterator insert( iterator pos, T & item )
+    {
+      lnode_t * link = node(&item);
+      link->next = link->prev = nullptr;
+
+      if (pos.c_node())
+        {
+          LAttachBefore(list_, link, pos.c_node());
+        }
+      else
+        {
+          LAttachLast(list_, link);
+        }
+
+      return iterator(list_, link);
+    }
+
+  iterator erase( iterator pos )
+    {
+      lnode_t * next = pos.c_node()->next;
+      LDetach(list_, pos.c_node());
+      return iterator(list_, next);
+    }
+
+  T * pop_front() { return object(LDetachFirst(list_)); }
+  T * pop_back()  { return object(LDetachLast(list_));  }
+
+
+  /*
+   *  Counting and finding by predicate.
+   */
+  template <typename Pred>
+  unsigned count_if( Pred pred ) const
+    {
+      unsigned match = 0;
+
+      for(lnode_t * link = list_->first; link; link = link->next)
+        {
+          match += (pred(*object(link)) ? 1 : 0);
+        }
+
+      return match;
+    }
+
+  template <typename Pred>
+  iterator find_if( Pred pred ) const
+    {
+      lnode_t * link = list_->first;
+
+      while(link && !pred(*object(link)))
+        {
+          link = link->next;
+        }
+
+      return iterator(list_, link);
+    }
+
+
+  /*
+   *  Detach objects matching by predicate, and pass them to dispose.
+   */
+  template <typename Pred, typename Dispose>
+  unsigned remove_if( Pred pred, Dispose dispose )
+    {
+      lnode_t * link  = list_->first;
+      unsigned  match = 0;
+
+      while(link)
+        {
+          lnode_t * next = link->next;
+
+          if (pred(*object(link)))
+            {
+              LDetach(list_, link);
+              dispose(object(link));
+              match++;
+            }
+
+          link = next;
+        }
+
+      return match;
+    }
+
+
+  /*
+   *  Detach the following equal objects (in sorted list), keeping the first one.
+   */
+  template <typename Equal, typename Dispose>
+  unsigned unique( Equal equal, Dispose dispose )
+    {
+      lnode_t * link  = list_->first;
+      unsigned  match = 0;
+
+      while(link && link->next)
+        {
+          lnode_t * next = link->next;
+
+          if (equal(*object(link), *object(next)))
+            {
+              LDetach(list_, next);
+              dispose(object(next));
+              match++;
+            }
+          else
+            {
+              link = next;
+            }
+        }
+
+      return match;
+    }
+
+
+  /*
+   *  Check if list is sorted (as LVerify), or if lists are equal in order.
+   */
+  template <typename Less>
+  bool is_sorted( Less less ) const
+    {
+      for(lnode_t * link = list_->first; link && link->next; link = link->next)
+        {
+          if (less(*object(link->next), *object(link)))
+            {
+              return false;
+            }
+        }
+
+      return true;
+    }
+
+  template <typename Equal>
+  bool equal( const llist & other, Equal equal ) const
+    {
+      lnode_t * link1 = list_->first;
+      lnode_t * link2 = other.list_->first;
+
+      if (LCount(list_) != LCount(other.list_))
+        {
+          return false;
+        }
+
+      for(; link1; link1 = link1->next, link2 = link2->next)
+        {
+          if (!equal(*object(link1), *object(link2)))
+            {
+              return false;
+            }
+        }
+
+      return true;
+    }
+
+
+  /*
+   *  Attach object before the first greater object (as LAttachSorted).
+   */
+  template <typename Less>
+  iterator insert_sorted( T & item, Less less )
+    {
+      lnode_t * link = list_->last;
+
+      while(link && less(item, *object(link)))
+        {
+          link = link->prev;
+        }
+
+      return insert(iterator(list_, link ? link->next : list_->first), item);
+    }
+
+
+  /*
+   *  Stable merge sort. Nodes are merged as singly linked runs, and
+   *  backward links are restored once at the end.
+   */
+  template <typename Less>
+  void sort( Less less )
+    {
+      lnode_t * runs[32] = { nullptr };
+      lnode_t * head = list_->first;
+      unsigned  i;
+
+      if (LCount(list_) < 2)
+        {
+          return;
+        }
+
+      LSortIndexDisable(list_);
+      LSortInvalidate(list_);
+
+      /*
+       *  Bottom-up: runs[i] holds sorted run of 2^i nodes (or NULL).
+       */
+      while(head)
+        {
+          lnode_t * run = head;
+          head = head->next;
+          run->next = nullptr;
+
+          for(i = 0; runs[i]; i++)
+            {
+              run = merge_runs(runs[i], run, less);
+              runs[i] = nullptr;
+            }
+
+          runs[i] = run;
+        }
+
+      for(i = 0; i < 32; i++)
+        {
+          if (runs[i])
+            {
+              head = (head ? merge_runs(runs[i], head, less) : runs[i]);
+            }
+        }
+
+      relink(head);
+    }
+
+
+  /*
+   *  Merge other sorted list into this one (other list is emptied).
+   */
+  template <typename Less>
+  void merge( llist & other, Less less )
+    {
+      lnode_t * first = list_->first;
+      lnode_t * other_first = other.list_->first;
+
+      if (!other_first)
+        {
+          return;
+        }
+
+      /*
+       *  Move nodes as they are (counts and key index), then merge the halves.
+       */
+      LSpliceRange(list_, list_->last, other.list_, other_first, other.list_->last, LCount(other.list_));
+
+      if (first)
+        {
+          other_first->prev->next = nullptr;
+          relink(merge_runs(first, other_first, less));
+        }
+    }
+
+private:
+
+  template <typename Less>
+  static lnode_t * merge_runs( lnode_t * run1, lnode_t * run2, Less less )
+    {
+      lnode_t   head;
+      lnode_t * tail = &head;
+
+      while(run1 && run2)
+        {
+          /* equal nodes are taken from the first run */
+          if (less(*object(run2), *object(run1)))
+            {
+              tail->next = run2;
+              run2 = run2->next;
+            }
+          else
+            {
+              tail->next = run1;
+              run1 = run1->next;
+            }
+
+          tail = tail->next;
+        }
+
+      tail->next = (run1 ? run1 : run2);
+
+      return head.next;
+    }
+
+  void relink( lnode_t * head )
+    {
+      lnode_t * prev = nullptr;
+
+      list_->first = head;
+
+      for(; head; head = head->next)
+        {
+          head->prev = prev;
+          prev = head;
+        }
+
+      list_->last = prev;
+      list_->version++;
+    }
+
+  llist_t * list_;
+};
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Example how to use the template.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *
+ *  struct event_t
+ *  {
+ *    int     time;
+ *    lnode_t link;
+ *  };
+ *
+ *  llist<event_t, &event_t::link> events( LInit(0, NULL, NULL) );
+ *
+ *  events.push_back(*event);
+ *  events.sort( [](const event_t & a, const event_t & b) { return a.time < b.time; } );
+ *
+ *  for( event_t & e : events )
+ *    {
+ *      printf("event at %d", e.time);
+ *    }
+ *
+ *  // C functions work with the same list.
+ *  LReverse( events.c_list() );
+ */
+
+
+/* --------------------------------------------------------------- */
+
+#ifdef LLIST_HPP_UNITTEST
+
+/*
+ *  gcc -c -DLLIST_OS_STUBS llist.c mpool.c
+ *  g++ -std=c++11 -x c++ -DLLIST_HPP_UNITTEST -o llist_hpp.exe llist.hpp -x none llist.o mpool.o
+ *
+ */
+
+#include <stdio.h>
+#include <assert.h>
+
+
+/*
+ *  Test structures, with LLIST_NODE fields and with lnode_t member.
+ *
+ */
+struct test_item_t
+{
+  LLIST_NODE
+  int id;
+  int value;
+};
+
+struct test_event_t
+{
+  int     time;
+  lnode_t link;
+};
+
+#define UNITTEST_ITEMS  12
+
+typedef llist<test_item_t> test_list_t;
+
+static test_item_t unittest_items[2][UNITTEST_ITEMS];
+static unsigned    unittest_disposed;
+
+static signed int unittest_compare( const lnode_t * node1, const lnode_t * node2 )
+{
+  return ((const test_item_t*)node1)->value - ((const test_item_t*)node2)->value;
+}
+
+static bool unittest_less( const test_item_t & a, const test_item_t & b )
+{
+  return a.value < b.value;
+}
+
+static void unittest_dispose( test_item_t * item )
+{
+  item->id = -1;
+  unittest_disposed++;
+}
+
+/* values of items are given, ids are their positions */
+static llist_t * unittest_generate_list( test_item_t * items, const int * values, unsigned count )
+{
+  test_list_t list( LInit(sizeof(test_item_t), NULL, NULL) );
+  unsigned    i;
+
+  for(i = 0; i < count; i++)
+    {
+      items[i].id    = (int)i;
+      items[i].value = values[i];
+      list.push_back(items[i]);
+    }
+
+  return list.c_list();
+}
+
+static void unittest_dispose_list( llist_t * list )
+{
+  (void)LDetachAll(list);
+  LDispose(&list);
+}
+
+
+/* ------ Testset 1 - iterators ------ */
+static void unittest_testset1( void )
+{
+  const int   values[] = { 5, 3, 8, 1, 9, 2 };
+  test_list_t list( unittest_generate_list(unittest_items[0], values, 6) );
+  test_event_t events[3] = { { 30, { nullptr, nullptr } }, { 10, { nullptr, nullptr } }, { 20, { nullptr, nullptr } } };
+  llist<test_event_t, &test_event_t::link> timeline( LInit(0, NULL, NULL) );
+  test_list_t::iterator it = list.begin();
+  int sum = 0;
+  int i;
+
+  printf("\nTestset 1 - iterators.\n\n");
+
+  for(test_item_t & item : list)
+    {
+      sum += item.value;
+    }
+
+  assert(sum == 28 && list.size() == 6 && !list.empty());
+  assert(list.front()->value == 5 && list.back()->value == 2);
+
+  i = 5;
+  for(test_list_t::reverse_iterator rit = list.rbegin(); rit != list.rend(); ++rit)
+    {
+      assert(rit->value == values[i--]);
+    }
+
+  assert((--list.end())->value == 2);
+  assert((++it)->value == 3 && (it++)->value == 3 && it->value == 8);
+
+  /* wrapper and C calls see the same nodes */
+  it = list.erase(it);
+  assert(it->value == 1 && LCount(list.c_list()) == 5);
+  assert(LFirst(list.c_list())->next == it.c_node()->prev);
+  it = list.insert(it, unittest_items[0][2]);
+  assert(it->value == 8 && LGetNode(list.c_list(), 2) == it.c_node());
+  assert(list.find_if([](const test_item_t & item) { return item.value > 8; })->id == 4);
+  assert(list.count_if([](const test_item_t & item) { return item.value < 4; }) == 3);
+  assert(list.find_if([](const test_item_t & item) { return item.value > 9; }) == list.end());
+
+  /* objects linked by member */
+  for(i = 0; i < 3; i++)
+    {
+      timeline.push_back(events[i]);
+    }
+
+  timeline.sort([](const test_event_t & a, const test_event_t & b) { return a.time < b.time; });
+  LReverse(timeline.c_list());
+  assert(timeline.front() == &events[0] && timeline.back() == &events[1]);
+  assert(test_list_t::object(nullptr) == nullptr);
+  assert(timeline.pop_front() == &events[0] && timeline.pop_back() == &events[1]);
+  assert(timeline.size() == 1);
+
+  (void)LDetachAll(timeline.c_list());
+  llist_t * c_timeline = timeline.c_list();
+  LDispose(&c_timeline);
+  unittest_dispose_list(list.c_list());
+}
+
+
+/* ------ Testset 2 - sort with C calls ------ */
+static void unittest_testset2( void )
+{
+  const int   values[UNITTEST_ITEMS] = { 7, 3, 7, 1, 12, 5, 3, 9, 0, 7, 4, 10 };
+  test_list_t list( unittest_generate_list(unittest_items[0], values, UNITTEST_ITEMS) );
+  lcolumn_t   column;
+  unsigned    position = 0;
+
+  printf("\nTestset 2 - sort with C calls.\n\n");
+
+  LColumnSetup(&column, list.c_list(), offsetof(test_item_t, value));
+  assert(LColumnCount(&column, 7, 7) == 3);
+  assert(((test_item_t*)LColumnFind(&column, 7, 7, &position))->id == 0);
+
+  /* stable, equal values stay in list order */
+  list.sort(unittest_less);
+  assert(list.is_sorted(unittest_less));
+  assert(LVerify(list.c_list(), unittest_compare) == LLIST_YES);
+  assert(list.front()->value == 0 && list.back()->value == 12);
+  assert(LCount(list.c_list()) == UNITTEST_ITEMS && !LPrev(LFirst(list.c_list())));
+
+  /* column is rebuilt after wrapper sort */
+  position = 0;
+  assert(((test_item_t*)LColumnFind(&column, 7, 7, &position))->id == 0);
+  assert(((test_item_t*)LColumnFind(&column, 7, 7, &position))->id == 2);
+  assert(((test_item_t*)LColumnFind(&column, 7, 7, &position))->id == 9);
+  assert(LColumnFind(&column, 3, 5, &position) == nullptr);
+  position = 0;
+  assert(((test_item_t*)LColumnFind(&column, 3, 5, &position))->id == 1);
+
+  /* order known by C sort is forgotten by wrapper sort */
+  list.sort([](const test_item_t & a, const test_item_t & b) { return a.id > b.id; });
+  assert(list.front()->id == UNITTEST_ITEMS - 1 && list.back()->id == 0);
+  assert(!list.is_sorted(unittest_less));
+  LSort(list.c_list(), unittest_compare);
+  assert(list.is_sorted(unittest_less));
+
+  /* C sort of wrapper sorted list, stable as well (reverse ids kept) */
+  assert(list.find_if([](const test_item_t & item) { return item.value == 7; })->id == 9);
+  assert(LColumnCount(&column, -100, 100) == UNITTEST_ITEMS);
+
+  LColumnDispose(&column);
+  unittest_dispose_list(list.c_list());
+}
+
+
+/* ------ Testset 3 - merge, unique and remove_if ------ */
+static void unittest_testset3( void )
+{
+  const int   values1[] = { 9, 1, 5, 3, 7, 5 };
+  const int   values2[] = { 4, 5, 0, 10, 2, 6, 8, 8 };
+  test_list_t list(  unittest_generate_list(unittest_items[0], values1, 6) );
+  test_list_t other( unittest_generate_list(unittest_items[1], values2, 8) );
+  lcolumn_t   column;
+
+  printf("\nTestset 3 - merge, unique and remove_if.\n\n");
+
+  LSort(list.c_list(), unittest_compare);
+  LSort(other.c_list(), unittest_compare);
+  LColumnSetup(&column, other.c_list(), offsetof(test_item_t, value));
+  assert(LColumnCount(&column, 8, 8) == 2);
+
+  /* equal values from this list first */
+  list.merge(other, unittest_less);
+  assert(other.empty() && LCount(other.c_list()) == 0);
+  assert(LColumnCount(&column, -100, 100) == 0);
+  assert(list.size() == 14 && list.is_sorted(unittest_less));
+  assert(LVerify(list.c_list(), unittest_compare) == LLIST_YES);
+  assert(list.find_if([](const test_item_t & item) { return item.value == 5; }).c_node() ==
+         (lnode_t*)&unittest_items[0][2]);
+  assert(LGetNode(list.c_list(), 13) == (lnode_t*)&unittest_items[1][3]);
+
+  /* merge into empty list */
+  other.merge(list, unittest_less);
+  assert(list.empty() && other.size() == 14);
+  list.merge(other, unittest_less);
+
+  unittest_disposed = 0;
+  assert(list.unique([](const test_item_t & a, const test_item_t & b) { return a.value == b.value; },
+                     unittest_dispose) == 3);
+  assert(unittest_disposed == 3 && list.size() == 11);
+  assert(unittest_items[0][5].id == -1 && unittest_items[1][1].id == -1 && unittest_items[1][7].id == -1);
+  assert(LVerify(list.c_list(), unittest_compare) == LLIST_YES);
+
+  assert(list.remove_if([](const test_item_t & item) { return item.value & 1; }, unittest_dispose) == 5);
+  assert(unittest_disposed == 8 && list.size() == 6);
+  assert(list.count_if([](const test_item_t & item) { return item.value & 1; }) == 0);
+  assert(LVerify(list.c_list(), unittest_compare) == LLIST_YES);
+  assert(LCount(list.c_list()) == 6 && list.back()->value == 10);
+
+  LColumnDispose(&column);
+  LColumnSetup(&column, list.c_list(), offsetof(test_item_t, value));
+  assert(LColumnCount(&column, 0, 4) == 3);
+
+  LColumnDispose(&column);
+  unittest_dispose_list(list.c_list());
+  unittest_dispose_list(other.c_list());
+}
+
+
+int main(void)
+{
+  printf("\nunittest - llist.hpp\n");
+
+  unittest_testset1();
+  unittest_testset2();
+  unittest_testset3();
+
+  printf("\nunittest - done.\n");
+  return 0;
+}
+
+#endif /* LLIST_HPP_UNITTEST */
+
+
+/* --------------------------------------------------------------- */
+
+#endif /* LLIST_HPP */
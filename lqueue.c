@@ -0,0 +1,700 @@
+/*
+ *  Concurrent Linked Queue
+ *
+ */
+
+/*
+ *  Concurrent Linked Queue Implementation.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *  Two lock queue: producers link nodes after tail under tail lock, and
+ *  consumers unlink nodes from head under head lock. Head and tail are
+ *  kept apart by the stub node, which is always in queue when it has no
+ *  user nodes: when consumer takes the last user node, it first pushes
+ *  the stub (as any producer), so that tail never points to popped node.
+ *
+ *  The next field of the node, where producer and consumer meet, is
+ *  accessed atomically (release/acquire). Waiting consumers are woken
+ *  only when there are any, thus producer takes head lock only then.
+ *
+ *  Lock-free MPSC queue (by D. Vyukov) has no tail lock: producer swaps
+ *  itself as the producer end by atomic exchange, and links the previous
+ *  node to itself after that. Until linked, the chain is broken, and the
+ *  consumer sees the queue as empty from that node on.
+ *
+ */
+
+/* ------------------------------------------------------------------------- */
+
+
+#ifdef LQUEUE_UNITTEST
+
+static void * os_block_alloc_and_clear(unsigned size);
+static void   os_block_dealloc(void * ptr);
+
+#else /* LQUEUE_UNITTEST */
+
+/* Embedded OS headers */
+#include "global.h"
+#include "type_def.h"
+#include "os.h"
+
+#endif /* LQUEUE_UNITTEST */
+
+/* External libraries */
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include "mpool.h"
+#include "llist.h"
+
+/* Library header */
+#include "lqueue.h"
+
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Locking primitives (POSIX threads, unless given by platform).
+ *
+ */
+#ifndef LQUEUE_OS_LOCKS
+#define LQMutexInit( mutex )        (void)pthread_mutex_init(mutex, NULL)
+#define LQMutexDestroy( mutex )     (void)pthread_mutex_destroy(mutex)
+#define LQLock( mutex )             (void)pthread_mutex_lock(mutex)
+#define LQUnlock( mutex )           (void)pthread_mutex_unlock(mutex)
+#define LQCondInit( cond )          (void)pthread_cond_init(cond, NULL)
+#define LQCondDestroy( cond )       (void)pthread_cond_destroy(cond)
+#define LQCondWait( cond, mutex )   (void)pthread_cond_wait(cond, mutex)
+#define LQCondSignal( cond )        (void)pthread_cond_signal(cond)
+#endif
+
+/*
+ *  Atomic access (GCC compatible builtins).
+ *
+ */
+#define _LQLoad( ptr )              __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define _LQStore( ptr, value )      __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#define _LQAdd( ptr, value )        (void)__atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST)
+#define _LQFence()                  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define _LQExchange( ptr, value )   __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL)
+
+
+/*
+ *  Link node after tail.
+ *
+ */
+static void LQueueLink( lqueue_t * queue, lnode_t * node )
+{
+  node->next = NULL;
+  node->prev = NULL;
+
+  LQLock(&queue->tail_lock);
+  _LQStore(&queue->tail->next, node);
+  queue->tail = node;
+  LQUnlock(&queue->tail_lock);
+}
+
+
+/*
+ *  Unlink the first user node (head lock held), or NULL if empty.
+ *
+ */
+static lnode_t * LQueueTake( lqueue_t * queue )
+{
+  lnode_t * node = queue->head;
+  lnode_t * next = _LQLoad(&node->next);
+
+  if (node == &queue->stub)
+    {
+      if (!next)
+        {
+          return NULL;
+        }
+
+      node = next;
+      next = _LQLoad(&node->next);
+    }
+
+  if (!next)
+    {
+      /*
+       *  Node is the last one, thus push the stub behind it first.
+       *  After that node has next node, either stub or newer one.
+       */
+      LQueueLink(queue, &queue->stub);
+      next = _LQLoad(&node->next);
+    }
+
+  queue->head = next;
+  _LQAdd(&queue->count, -1);
+
+  node->next = NULL;
+
+  return node;
+}
+
+
+/*
+ *  Allocates new queue object from RAM.
+ *
+ */
+lqueue_t * LQueueInit( unsigned node_size, void * memorypool )
+{
+  lqueue_t * queue = (lqueue_t*)os_block_alloc_and_clear(sizeof(lqueue_t));
+
+  queue->head       = &queue->stub;
+  queue->tail       = &queue->stub;
+  queue->node_size  = node_size;
+  queue->memorypool = memorypool;
+
+  LQMutexInit(&queue->head_lock);
+  LQMutexInit(&queue->tail_lock);
+  LQMutexInit(&queue->pool_lock);
+  LQCondInit(&queue->nonempty);
+
+  return queue;
+}
+
+
+/*
+ *  Deallocates queue and the nodes left in it (no threads may use it anymore).
+ *
+ */
+void LQueueDispose( lqueue_t ** queue )
+{
+  lnode_t * node;
+
+  if (queue && *queue)
+    {
+      while((node = LQueuePop(*queue, LLIST_NO)) != NULL)
+        {
+          if ((*queue)->node_size)
+            {
+              LQueueDealloc(*queue, node);
+            }
+        }
+
+      LQMutexDestroy(&(*queue)->head_lock);
+      LQMutexDestroy(&(*queue)->tail_lock);
+      LQMutexDestroy(&(*queue)->pool_lock);
+      LQCondDestroy(&(*queue)->nonempty);
+
+      os_block_dealloc(*queue);
+      *queue = NULL;
+    }
+}
+
+
+/*
+ *  Allocate node from memory pool (under lock) or from OS.
+ *
+ */
+lnode_t * LQueueAlloc( lqueue_t * queue )
+{
+  lnode_t * node;
+
+  if (queue->memorypool)
+    {
+      LQLock(&queue->pool_lock);
+      node = (lnode_t*)MPoolAlloc(queue->memorypool);
+      LQUnlock(&queue->pool_lock);
+    }
+  else
+    {
+      node = (lnode_t*)os_block_alloc_and_clear(queue->node_size);
+    }
+
+  return node;
+}
+
+
+/*
+ *
+ *
+ */
+void LQueueDealloc( lqueue_t * queue, lnode_t * node )
+{
+  if (queue->memorypool)
+    {
+      LQLock(&queue->pool_lock);
+      MPoolDealloc(queue->memorypool, (void*)&node);
+      LQUnlock(&queue->pool_lock);
+    }
+  else
+    {
+      os_block_dealloc(node);
+    }
+}
+
+
+/*
+ *  Push node as last, and wake up a waiting consumer if any.
+ *
+ */
+void LQueuePush( lqueue_t * queue, lnode_t * node )
+{
+  _LQAdd(&queue->count, 1);
+  LQueueLink(queue, node);
+
+  /*
+   *  Either the consumer sees the node, or this sees the consumer waiting.
+   *  Consumer holds head lock until it waits, thus signal is not lost.
+   */
+  _LQFence();
+
+  if (_LQLoad(&queue->waiting))
+    {
+      LQLock(&queue->head_lock);
+      LQCondSignal(&queue->nonempty);
+      LQUnlock(&queue->head_lock);
+    }
+}
+
+
+/*
+ *  Pop the first node, optionally waiting until there is one.
+ *
+ */
+lnode_t * LQueuePop( lqueue_t * queue, lbool_e wait )
+{
+  lnode_t * node;
+
+  LQLock(&queue->head_lock);
+
+  if (wait)
+    {
+      _LQAdd(&queue->waiting, 1);
+
+      while((node = LQueueTake(queue)) == NULL)
+        {
+          LQCondWait(&queue->nonempty, &queue->head_lock);
+        }
+
+      _LQAdd(&queue->waiting, -1);
+    }
+  else
+    {
+      node = LQueueTake(queue);
+    }
+
+  LQUnlock(&queue->head_lock);
+
+  return node;
+}
+
+
+/*
+ *
+ *
+ */
+unsigned LQueueCount( lqueue_t * queue )
+{
+  return _LQLoad(&queue->count);
+}
+
+
+/*
+ *  Setup the lock-free queue with only stub in it.
+ *
+ */
+void LMpscSetup( lmpsc_t * queue )
+{
+  (void)memset(queue, 0, sizeof(lmpsc_t));
+
+  queue->out = &queue->stub;
+  queue->in  = &queue->stub;
+}
+
+
+/*
+ *  Attach node as last (any thread).
+ *
+ */
+void LMpscAttachLast( lmpsc_t * queue, lnode_t * node )
+{
+  lnode_t * prev;
+
+  node->next = NULL;
+  node->prev = NULL;
+
+  prev = _LQExchange(&queue->in, node);
+  _LQStore(&prev->next, node);
+}
+
+
+/*
+ *  Detach the first node (consumer thread), NULL if none available.
+ *
+ */
+lnode_t * LMpscDetachFirst( lmpsc_t * queue )
+{
+  lnode_t * node = queue->out;
+  lnode_t * next = _LQLoad(&node->next);
+
+  if (node == &queue->stub)
+    {
+      if (!next)
+        {
+          return NULL;
+        }
+
+      queue->out = next;
+      node = next;
+      next = _LQLoad(&node->next);
+    }
+
+  if (next)
+    {
+      queue->out = next;
+      node->next = NULL;
+      return node;
+    }
+
+  if (node != _LQLoad(&queue->in))
+    {
+      /* producer has not linked its node yet */
+      return NULL;
+    }
+
+  /*
+   *  Node is the last one, thus push the stub behind it first.
+   */
+  LMpscAttachLast(queue, &queue->stub);
+  next = _LQLoad(&node->next);
+
+  if (next)
+    {
+      queue->out = next;
+      node->next = NULL;
+      return node;
+    }
+
+  return NULL;
+}
+
+
+/*
+ *  Detach all available nodes and attach them as last into list.
+ *
+ */
+unsigned LMpscDrain( lmpsc_t * queue, llist_t * list )
+{
+  lnode_t * first = NULL;
+  lnode_t * last  = NULL;
+  lnode_t * node;
+  unsigned  count = 0;
+
+  while((node = LMpscDetachFirst(queue)) != NULL)
+    {
+      node->prev = last;
+
+      if (last)
+        {
+          last->next = node;
+        }
+      else
+        {
+          first = node;
+        }
+
+      last = node;
+      count++;
+    }
+
+  if (first)
+    {
+      LAttachLast(list, first);
+    }
+
+  return count;
+}
+
+
+/* --------------------------------------------------------------- */
+
+#ifdef LQUEUE_UNITTEST
+
+/*
+ *  gcc -DLQUEUE_UNITTEST -DLLIST_OS_STUBS -o lqueue.exe lqueue.c llist.c mpool.c -lpthread
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static void * os_block_alloc_and_clear(unsigned size)
+{
+  return memset(malloc(size), 0, size);
+}
+
+static void os_block_dealloc(void* ptr)
+{
+  free(ptr);
+}
+
+
+/*
+ *  Test structure
+ *
+ */
+typedef struct
+{
+  LLIST_NODE
+  unsigned producer;
+  unsigned value;
+} test_job_t;
+
+#define UNITTEST_PRODUCERS  4
+#define UNITTEST_CONSUMERS  3
+#define UNITTEST_JOBS       20000
+
+static lqueue_t * unittest_queue;
+static unsigned   unittest_sums[UNITTEST_CONSUMERS];
+
+
+/* ------ Testset 1 - single thread ------ */
+static void unittest_testset1( void )
+{
+  lqueue_t * queue = LQueueInit(sizeof(test_job_t), NULL);
+  test_job_t * job;
+  unsigned i;
+
+  printf("\nTestset 1 - single thread.\n\n");
+
+  assert(LQueuePop(queue, LLIST_NO) == NULL);
+
+  for(i = 0; i < 5; i++)
+    {
+      job = (test_job_t*)LQueueAlloc(queue);
+      job->value = i;
+      LQueuePush(queue, (lnode_t*)job);
+    }
+
+  assert(LQueueCount(queue) == 5);
+
+  /* first in, first out, also across the stub */
+  for(i = 0; i < 3; i++)
+    {
+      job = (test_job_t*)LQueuePop(queue, LLIST_YES);
+      assert(job->value == i);
+      LQueueDealloc(queue, (lnode_t*)job);
+    }
+
+  job = (test_job_t*)LQueueAlloc(queue);
+  job->value = 5;
+  LQueuePush(queue, (lnode_t*)job);
+
+  for(i = 3; i < 6; i++)
+    {
+      job = (test_job_t*)LQueuePop(queue, LLIST_NO);
+      assert(job && job->value == i);
+      LQueueDealloc(queue, (lnode_t*)job);
+    }
+
+  assert(LQueuePop(queue, LLIST_NO) == NULL);
+  assert(LQueueCount(queue) == 0);
+
+  /* nodes left in queue are deallocated */
+  LQueuePush(queue, LQueueAlloc(queue));
+  LQueueDispose(&queue);
+  assert(queue == NULL);
+}
+
+
+/* ------ Testset 2 - producers and consumers ------ */
+static void * unittest_producer( void * arg )
+{
+  unsigned producer = (unsigned)(size_t)arg;
+  unsigned i;
+
+  for(i = 1; i <= UNITTEST_JOBS; i++)
+    {
+      test_job_t * job = (test_job_t*)LQueueAlloc(unittest_queue);
+      job->producer = producer;
+      job->value    = i;
+      LQueuePush(unittest_queue, (lnode_t*)job);
+    }
+
+  return NULL;
+}
+
+static void * unittest_consumer( void * arg )
+{
+  unsigned   consumer = (unsigned)(size_t)arg;
+  unsigned   last[UNITTEST_PRODUCERS] = {0};
+
+  for(;;)
+    {
+      test_job_t * job = (test_job_t*)LQueuePop(unittest_queue, LLIST_YES);
+
+      if (job->value == 0)
+        {
+          /* end marker */
+          LQueueDealloc(unittest_queue, (lnode_t*)job);
+          break;
+        }
+
+      /* jobs of one producer arrive in order */
+      assert(job->value > last[job->producer]);
+      last[job->producer] = job->value;
+
+      unittest_sums[consumer] += job->value;
+      LQueueDealloc(unittest_queue, (lnode_t*)job);
+    }
+
+  return NULL;
+}
+
+static void unittest_testset2( void )
+{
+  pthread_t producers[UNITTEST_PRODUCERS];
+  pthread_t consumers[UNITTEST_CONSUMERS];
+  void *    pool = MPoolInit(sizeof(test_job_t), MPOOL_WAIT, MPOOL_ZERO_MEMSET);
+  unsigned  sum  = 0;
+  unsigned  i;
+  int       rc;
+
+  printf("\nTestset 2 - producers and consumers.\n\n");
+
+  unittest_queue = LQueueInit(sizeof(test_job_t), pool);
+
+  for(i = 0; i < UNITTEST_CONSUMERS; i++)
+    {
+      rc = pthread_create(&consumers[i], NULL, unittest_consumer, (void*)(size_t)i);
+      assert(rc == 0);
+    }
+
+  for(i = 0; i < UNITTEST_PRODUCERS; i++)
+    {
+      rc = pthread_create(&producers[i], NULL, unittest_producer, (void*)(size_t)i);
+      assert(rc == 0);
+    }
+
+  for(i = 0; i < UNITTEST_PRODUCERS; i++)
+    {
+      (void)pthread_join(producers[i], NULL);
+    }
+
+  for(i = 0; i < UNITTEST_CONSUMERS; i++)
+    {
+      LQueuePush(unittest_queue, LQueueAlloc(unittest_queue));
+    }
+
+  for(i = 0; i < UNITTEST_CONSUMERS; i++)
+    {
+      (void)pthread_join(consumers[i], NULL);
+      sum += unittest_sums[i];
+      printf("consumer %d sum %u\n", i, unittest_sums[i]);
+    }
+
+  assert(sum == UNITTEST_PRODUCERS * (UNITTEST_JOBS * (UNITTEST_JOBS + 1) / 2));
+  assert(LQueueCount(unittest_queue) == 0);
+  assert(MPoolGetStatistics(pool).blocks_used == 0);
+
+  LQueueDispose(&unittest_queue);
+  MPoolDispose(&pool);
+}
+
+
+/* ------ Testset 3 - lock-free queue ------ */
+static lmpsc_t unittest_mpsc;
+
+static void * unittest_mpsc_producer( void * arg )
+{
+  unsigned producer = (unsigned)(size_t)arg;
+  unsigned i;
+
+  for(i = 1; i <= UNITTEST_JOBS; i++)
+    {
+      test_job_t * job = (test_job_t*)os_block_alloc_and_clear(sizeof(test_job_t));
+      job->producer = producer;
+      job->value    = i;
+      LMpscAttachLast(&unittest_mpsc, (lnode_t*)job);
+    }
+
+  return NULL;
+}
+
+static void unittest_testset3( void )
+{
+  pthread_t producers[UNITTEST_PRODUCERS];
+  unsigned  last[UNITTEST_PRODUCERS] = {0};
+  llist_t * list = LInit(sizeof(test_job_t), NULL, NULL);
+  test_job_t * job;
+  unsigned  count = 0;
+  unsigned  i;
+  int       rc;
+
+  printf("\nTestset 3 - lock-free queue.\n\n");
+
+  LMpscSetup(&unittest_mpsc);
+  assert(LMpscDetachFirst(&unittest_mpsc) == NULL);
+
+  /* single thread, first in first out */
+  for(i = 0; i < 3; i++)
+    {
+      job = (test_job_t*)os_block_alloc_and_clear(sizeof(test_job_t));
+      job->value = i;
+      LMpscAttachLast(&unittest_mpsc, (lnode_t*)job);
+    }
+
+  job = (test_job_t*)LMpscDetachFirst(&unittest_mpsc);
+  assert(job->value == 0);
+  os_block_dealloc(job);
+
+  assert(LMpscDrain(&unittest_mpsc, list) == 2);
+  assert(LCount(list) == 2 && ((test_job_t*)LFirst(list))->value == 1);
+  assert(LMpscDetachFirst(&unittest_mpsc) == NULL);
+  LRemoveAll(list);
+
+  /* producers, while this thread drains */
+  for(i = 0; i < UNITTEST_PRODUCERS; i++)
+    {
+      rc = pthread_create(&producers[i], NULL, unittest_mpsc_producer, (void*)(size_t)i);
+      assert(rc == 0);
+    }
+
+  while(count < UNITTEST_PRODUCERS * UNITTEST_JOBS)
+    {
+      count += LMpscDrain(&unittest_mpsc, list);
+
+      LFor(test_job_t*, job, list)
+        {
+          /* jobs of one producer arrive in order */
+          assert(job->value == last[job->producer] + 1);
+          last[job->producer] = job->value;
+        }
+
+      LRemoveAll(list);
+    }
+
+  for(i = 0; i < UNITTEST_PRODUCERS; i++)
+    {
+      (void)pthread_join(producers[i], NULL);
+      assert(last[i] == UNITTEST_JOBS);
+    }
+
+  assert(LMpscDetachFirst(&unittest_mpsc) == NULL);
+  printf("drained %u nodes\n", count);
+
+  LDispose(&list);
+}
+
+
+/*
+ *  Test harness for concurrent queue.
+ *
+ */
+int main(void)
+{
+  printf("\nunittest - lqueue.c\n");
+
+  unittest_testset1();
+  unittest_testset2();
+  unittest_testset3();
+
+  printf("\nunittest - done.\n");
+  return 0;
+}
+
+#endif /* LQUEUE_UNITTEST */
@@ -0,0 +1,189 @@
+/*
+ *  Concurrent Linked Queue Header
+ *
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#ifndef LQUEUE_H
+#define LQUEUE_H
+
+
+#include "llist.h"
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Thread safe linked queue for producer/consumer use.
+ *
+ *  Nodes are the same lnode_t nodes as with llist.h (LLIST_NODE in the
+ *  beginning of structure), thus popped node can be attached into any
+ *  linked list and vice versa. Queue has separate locks for its head
+ *  and tail, so that producers (LQueuePush) and consumers (LQueuePop)
+ *  do not block each other. Queue always holds one internal stub node,
+ *  thus head and tail never point to same user node, and the stub is
+ *  pushed back to queue when the last user node is popped.
+ *
+ *   head                                      tail
+ *    |                                         |
+ *  [stub]->[node]->[node]->[node]->....->[node]
+ *
+ *  Nodes can be allocated from memory pool (mpool.h), which is used
+ *  under its own lock, since memory pool itself is not thread safe.
+ *
+ *  Lock-free multi-producer single-consumer queue (lmpsc_t) works
+ *  in the same way with stub node, but producers link nodes by one
+ *  atomic exchange of the producer end, and only one thread consumes.
+ *
+ *  Locks map to POSIX threads by default. For other platforms define
+ *  LQUEUE_OS_LOCKS and the lq_mutex_t/lq_cond_t types and LQ* lock
+ *  macros (see lqueue.c) to the services of the OS.
+ *
+ */
+
+/* --------------------------------------------------------------- */
+/* 1. Structure and prototypes for queue usage                     */
+/* --------------------------------------------------------------- */
+
+
+#ifndef LQUEUE_OS_LOCKS
+#include <pthread.h>
+
+typedef pthread_mutex_t  lq_mutex_t;
+typedef pthread_cond_t   lq_cond_t;
+#endif
+
+
+/*
+ *  (lqueue_t*) -  Queue type, only accessed by LQueue* functions.
+ */
+typedef struct
+{
+  lnode_t *   head;          /* Next node to pop (may be stub) */
+  lnode_t *   tail;          /* Last pushed node               */
+  lnode_t     stub;
+
+  lq_mutex_t  head_lock;
+  lq_mutex_t  tail_lock;
+  lq_cond_t   nonempty;
+  unsigned    waiting;       /* Consumers waiting for nodes    */
+  unsigned    count;
+
+  /*
+   *  Node allocation (optional), memory pool or OS.
+   */
+  unsigned    node_size;
+  void *      memorypool;
+  lq_mutex_t  pool_lock;
+
+} lqueue_t;
+
+
+/*
+ *  Size of cache line, producer and consumer ends of lock-free
+ *  queue are kept apart to avoid false sharing between them.
+ */
+#ifndef LQUEUE_CACHE_LINE
+#define LQUEUE_CACHE_LINE  64
+#endif
+
+
+/*
+ *  (lmpsc_t) -  Lock-free multi-producer single-consumer queue,
+ *  only accessed by LMpsc* functions (can be static object).
+ */
+typedef struct
+{
+  lnode_t *   out;           /* Consumer end (may be stub)     */
+  lnode_t     stub;
+  char        padding[LQUEUE_CACHE_LINE];
+  lnode_t *   in;            /* Producer end, last pushed node */
+
+} lmpsc_t;
+
+
+/* --------------------------------------------------------------- */
+/* 2. Functions for queue handling.                                */
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Initialize (and allocate) the queue object. Node size and memory pool
+ *  are needed only for LQueueAlloc (pool block size must be the node size).
+ *  Disposing deallocates also all nodes left in queue (if node size given).
+ */
+lqueue_t * LQueueInit( unsigned node_size, void * memorypool );
+void       LQueueDispose( lqueue_t ** queue );
+
+
+/*
+ *  Allocate (cleared) and deallocate nodes, safe from any thread.
+ */
+lnode_t *  LQueueAlloc(   lqueue_t * queue );
+void       LQueueDealloc( lqueue_t * queue, lnode_t * node );
+
+
+/*
+ *  Push node as last, or pop the first node. With LLIST_YES wait, pop
+ *  blocks until there is node available, otherwise NULL is returned if
+ *  the queue is empty. Count is only a snapshot, as queue is shared.
+ */
+void       LQueuePush( lqueue_t * queue, lnode_t * node );
+lnode_t *  LQueuePop(  lqueue_t * queue, lbool_e wait );
+unsigned   LQueueCount( lqueue_t * queue );
+
+
+/* --------------------------------------------------------------- */
+/* 3. Functions for lock-free MPSC queue handling.                 */
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Setup the queue object (no allocations).
+ */
+void       LMpscSetup( lmpsc_t * queue );
+
+
+/*
+ *  Attach node as last from any thread (one atomic exchange, never blocks).
+ *  Detach the first node or drain all available nodes as last into the list,
+ *  only from one consumer thread at a time. Detaching returns NULL also when
+ *  producer is just attaching the only node, as it can not be taken yet.
+ */
+void       LMpscAttachLast(  lmpsc_t * queue, lnode_t * node );
+lnode_t *  LMpscDetachFirst( lmpsc_t * queue );
+unsigned   LMpscDrain(       lmpsc_t * queue, llist_t * list );
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Example how to use queue between threads.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *
+ *  lqueue_t * jobs = LQueueInit(sizeof(job_t), MPoolInit(sizeof(job_t), MPOOL_WAIT, MPOOL_ZERO_MEMSET));
+ *
+ *  // producer thread
+ *  job_t * job = (job_t*)LQueueAlloc(jobs);
+ *  job->id = 1;
+ *  LQueuePush(jobs, (lnode_t*)job);
+ *
+ *  // consumer thread
+ *  job = (job_t*)LQueuePop(jobs, LLIST_YES);
+ *  ...
+ *  LQueueDealloc(jobs, (lnode_t*)job);
+ */
+
+
+/* --------------------------------------------------------------- */
+
+#endif /* LQUEUE_H */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,464 @@
+/*
+ *  Linked List Timer Wheel
+ *
+ */
+
+/*
+ *  Linked List Timer Wheel Implementation.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *  Timer is placed by the distance of its expiry from the last processed
+ *  tick: level is the highest non-zero LTIMER_SLOT_BITS digit of distance,
+ *  and slot is the same digit of the expiry tick itself. Thus the slot of
+ *  level N timer is cascaded exactly when the lower digits of the current
+ *  tick wrap to zero at the beginning of its range, and after that the
+ *  timer is placed by the remaining distance to a lower level.
+ *
+ *  Processing one tick: if level 0 wrapped, level 1 slot is cascaded (and
+ *  level 2, if level 1 wrapped too, and so on), and then the level 0 slot
+ *  of the tick is moved to expired list as a whole.
+ *
+ *  Wheel lists have no node size nor memory pool, they only link timers.
+ *
+ */
+
+/* ------------------------------------------------------------------------- */
+
+
+/* External libraries */
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include "llist.h"
+
+/* Library header */
+#include "ltimer.h"
+
+/* --------------------------------------------------------------- */
+
+
+#define _LTimerDigit( ticks, level )   (((ticks) >> ((level) * LTIMER_SLOT_BITS)) & (LTIMER_SLOTS - 1))
+#define _LTimerLevel( wheel, slot )    ((unsigned)((slot) - &(wheel)->slots[0][0]) / LTIMER_SLOTS)
+
+
+/*
+ *  Setup the wheel.
+ *
+ */
+void LTimerSetup( lwheel_t * wheel, unsigned now )
+{
+  unsigned level, slot;
+
+  wheel->now   = now;
+  wheel->count = 0;
+
+  for(level = 0; level < LTIMER_LEVELS; level++)
+    {
+      wheel->levels[level] = 0;
+
+      for(slot = 0; slot < LTIMER_SLOTS; slot++)
+        {
+          LSetup(wheel->slots[level][slot], 0, NULL);
+        }
+    }
+}
+
+
+/*
+ *  Attach timer into the slot of its expiry.
+ *
+ */
+static void LTimerPlace( lwheel_t * wheel, ltimer_t * timer )
+{
+  unsigned distance = timer->expires - wheel->now;
+  unsigned level = 0;
+
+  while((distance >> LTIMER_SLOT_BITS) && level < LTIMER_LEVELS - 1)
+    {
+      distance >>= LTIMER_SLOT_BITS;
+      level++;
+    }
+
+  timer->slot = &wheel->slots[level][_LTimerDigit(timer->expires, level)];
+  LAttachLast(timer->slot, (lnode_t*)timer);
+  wheel->levels[level]++;
+}
+
+
+/*
+ *  Arm timer.
+ *
+ */
+void LTimerArm( lwheel_t * wheel, ltimer_t * timer, unsigned ticks )
+{
+  (void)LTimerCancel(wheel, timer);
+
+  if (ticks == 0)
+    {
+      ticks = 1;
+    }
+  else if (ticks > LTIMER_MAX_TICKS)
+    {
+      ticks = LTIMER_MAX_TICKS;
+    }
+
+  timer->next    = NULL;
+  timer->prev    = NULL;
+  timer->expires = wheel->now + ticks;
+
+  LTimerPlace(wheel, timer);
+  wheel->count++;
+}
+
+
+/*
+ *  Cancel timer.
+ *
+ */
+lbool_e LTimerCancel( lwheel_t * wheel, ltimer_t * timer )
+{
+  if (!timer->slot)
+    {
+      return LLIST_NO;
+    }
+
+  LDetach(timer->slot, (lnode_t*)timer);
+  wheel->levels[_LTimerLevel(wheel, timer->slot)]--;
+  wheel->count--;
+  timer->slot = NULL;
+
+  return LLIST_YES;
+}
+
+
+/*
+ *  Move timers of higher level slot to lower levels.
+ *
+ */
+static void LTimerCascade( lwheel_t * wheel, llist_t * slot )
+{
+  ltimer_t * timer;
+
+  wheel->levels[_LTimerLevel(wheel, slot)] -= LCount(slot);
+
+  while((timer = (ltimer_t*)LDetachFirst(slot)) != NULL)
+    {
+      LTimerPlace(wheel, timer);
+    }
+}
+
+
+/*
+ *  Amount of ticks, on which nothing expires nor cascades. When lower
+ *  levels are empty, ticks can be skipped until their digits wrap to zero.
+ *
+ */
+static unsigned LTimerIdle( lwheel_t * wheel )
+{
+  unsigned level = 0;
+  unsigned span;
+
+  while(level < LTIMER_LEVELS - 1 && wheel->levels[level] == 0)
+    {
+      level++;
+    }
+
+  span = 1u << (level * LTIMER_SLOT_BITS);
+
+  return span - 1 - (wheel->now & (span - 1));
+}
+
+
+/*
+ *  Advance wheel tick by tick (idle ticks are skipped).
+ *
+ */
+unsigned LTimerAdvance( lwheel_t * wheel, unsigned now, llist_t * expired )
+{
+  unsigned count = 0;
+
+  while(wheel->now != now)
+    {
+      llist_t * slot;
+      lnode_t * node;
+      unsigned  level;
+      unsigned  idle = (wheel->count ? LTimerIdle(wheel) : LTIMER_MAX_TICKS);
+
+      if (idle >= now - wheel->now)
+        {
+          /* nothing to expire on the way */
+          wheel->now = now;
+          break;
+        }
+
+      wheel->now += idle + 1;
+
+      for(level = 1; level < LTIMER_LEVELS && _LTimerDigit(wheel->now, level - 1) == 0; level++)
+        {
+          LTimerCascade(wheel, &wheel->slots[level][_LTimerDigit(wheel->now, level)]);
+        }
+
+      slot = &wheel->slots[0][_LTimerDigit(wheel->now, 0)];
+
+      if (LCount(slot))
+        {
+          LFor(lnode_t*, node, slot)
+            {
+              ((ltimer_t*)node)->slot = NULL;
+            }
+
+          count            += LCount(slot);
+          wheel->count     -= LCount(slot);
+          wheel->levels[0] -= LCount(slot);
+
+          LSpliceRange(expired, LLast(expired), slot, LFirst(slot), LLast(slot), LCount(slot));
+        }
+    }
+
+  return count;
+}
+
+
+/* --------------------------------------------------------------- */
+
+#ifdef LTIMER_UNITTEST
+
+/*
+ *  gcc -DLTIMER_UNITTEST -DLLIST_OS_STUBS -o ltimer.exe ltimer.c llist.c mpool.c
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/*
+ *  Test structure
+ *
+ */
+typedef struct
+{
+  LTIMER_NODE
+  unsigned id;
+  unsigned due;
+} test_timer_t;
+
+#define UNITTEST_TIMERS  20000
+
+static test_timer_t unittest_timers[UNITTEST_TIMERS];
+static unsigned     unittest_random = 2463534242u;
+
+static unsigned unittest_rand( void )
+{
+  /* xorshift32 */
+  unittest_random ^= unittest_random << 13;
+  unittest_random ^= unittest_random >> 17;
+  unittest_random ^= unittest_random << 5;
+
+  return unittest_random;
+}
+
+static void unittest_arm( lwheel_t * wheel, unsigned id, unsigned ticks )
+{
+  test_timer_t * timer = &unittest_timers[id];
+
+  timer->id  = id;
+  timer->due = LTimerNow(wheel) + ticks;
+  LTimerArm(wheel, (ltimer_t*)timer, ticks);
+}
+
+static signed int unittest_compare( const lnode_t * node1, const lnode_t * node2 )
+{
+  return (((test_timer_t*)node1)->due < ((test_timer_t*)node2)->due ? LNODECMP_SMALLER :
+          ((test_timer_t*)node1)->due > ((test_timer_t*)node2)->due ? LNODECMP_GREATER : LNODECMP_EQUAL);
+}
+
+
+/* ------ Testset 1 - expiry at exact tick ------ */
+static void unittest_testset1( void )
+{
+  static lwheel_t wheel;
+  static unsigned ticks[] = { 1, 2, 63, 64, 65, 127, 128, 4095, 4096, 4097, 70000, 262144, 300001 };
+  llist_t         expired;
+  test_timer_t *  timer;
+  unsigned        i, now, fired = 0;
+
+  printf("\n- Testset 1 -\n");
+
+  /* start near wrap around of ticks */
+  LTimerSetup(&wheel, 0u - 100000u);
+  LSetup(expired, 0, NULL);
+
+  for(i = 0; i < sizeof(ticks) / sizeof(ticks[0]); i++)
+    {
+      unittest_arm(&wheel, i, ticks[i]);
+    }
+
+  /* zero ticks expires at next tick, cancelled never */
+  unittest_arm(&wheel, 20, 0);
+  unittest_timers[20].due++;
+  unittest_arm(&wheel, 21, 5);
+  assert(LTimerCancel(&wheel, (ltimer_t*)&unittest_timers[21]) == LLIST_YES);
+  assert(LTimerCancel(&wheel, (ltimer_t*)&unittest_timers[21]) == LLIST_NO);
+
+  /* re-armed later */
+  unittest_arm(&wheel, 22, 10);
+  unittest_arm(&wheel, 22, 1000);
+
+  assert(LTimerCount(&wheel) == sizeof(ticks) / sizeof(ticks[0]) + 2);
+
+  for(now = LTimerNow(&wheel) + 1; LTimerCount(&wheel) > 0; now++)
+    {
+      fired += LTimerAdvance(&wheel, now, &expired);
+
+      while((timer = (test_timer_t*)LDetachFirst(&expired)) != NULL)
+        {
+          assert(timer->due == now);
+          assert(!LTimerArmed((ltimer_t*)timer));
+          assert(timer->id != 21);
+        }
+    }
+
+  assert(fired == sizeof(ticks) / sizeof(ticks[0]) + 2);
+  assert(LTimerNow(&wheel) == 0u - 100000u + 300001u);
+
+  /* maximum is clamped */
+  unittest_arm(&wheel, 0, ~0u);
+  assert(unittest_timers[0].expires == LTimerNow(&wheel) + LTIMER_MAX_TICKS);
+
+  assert(LTimerAdvance(&wheel, LTimerNow(&wheel) + LTIMER_MAX_TICKS - 1, &expired) == 0);
+  assert(LTimerAdvance(&wheel, LTimerNow(&wheel) + 1, &expired) == 1);
+  assert(LFirst(&expired) == (lnode_t*)&unittest_timers[0]);
+
+  /* empty wheel jumps */
+  assert(LTimerAdvance(&wheel, 12345, &expired) == 0);
+  assert(LTimerNow(&wheel) == 12345);
+
+  printf("OK\n");
+}
+
+
+/* ------ Testset 2 - random timers in batches ------ */
+static void unittest_testset2( void )
+{
+  static lwheel_t wheel;
+  llist_t         expired;
+  test_timer_t *  timer;
+  unsigned        i, now, last, count;
+  unsigned        fired = 0, cancelled = 0;
+
+  printf("\n- Testset 2 -\n");
+
+  LTimerSetup(&wheel, 5000);
+  LSetup(expired, 0, NULL);
+  (void)memset(unittest_timers, 0, sizeof(unittest_timers));
+
+  for(i = 0; i < UNITTEST_TIMERS; i++)
+    {
+      unittest_arm(&wheel, i, unittest_rand() % (1u << (unittest_rand() % 21)));
+      unittest_timers[i].due = unittest_timers[i].expires;
+    }
+
+  for(i = 0; i < UNITTEST_TIMERS; i += 7)
+    {
+      cancelled += LTimerCancel(&wheel, (ltimer_t*)&unittest_timers[i]);
+    }
+
+  while(LTimerCount(&wheel) > 0)
+    {
+      last = LTimerNow(&wheel);
+      now  = last + 1 + unittest_rand() % 5000;
+
+      count = LTimerAdvance(&wheel, now, &expired);
+      assert(count == LCount(&expired));
+      assert(LVerify(&expired, unittest_compare) == LLIST_YES);
+
+      while((timer = (test_timer_t*)LDetachFirst(&expired)) != NULL)
+        {
+          assert(timer->due - last - 1 < now - last);
+          assert(timer->id % 7 != 0);
+        }
+
+      fired += count;
+    }
+
+  assert(fired + cancelled == UNITTEST_TIMERS);
+
+  printf("OK\n");
+}
+
+
+/* ------ Testset 3 - benchmark against sorted list ------ */
+static void unittest_testset3( void )
+{
+  static lwheel_t wheel;
+  llist_t         sorted;
+  llist_t         expired;
+  clock_t         time;
+  unsigned        i, now;
+
+  printf("\n- Testset 3 -\n");
+
+  LTimerSetup(&wheel, 0);
+  LSetup(sorted, 0, NULL);
+  LSetup(expired, 0, NULL);
+  (void)memset(unittest_timers, 0, sizeof(unittest_timers));
+
+  unittest_random = 2463534242u;
+  time = clock();
+
+  for(i = 0; i < UNITTEST_TIMERS; i++)
+    {
+      unittest_timers[i].due = 1 + unittest_rand() % 100000;
+      LAttachSorted(&sorted, (lnode_t*)&unittest_timers[i], unittest_compare, LLOOP_BACKWARD);
+    }
+
+  printf("Sorted list: %u timers armed in %u ms\n", UNITTEST_TIMERS,
+         (unsigned)((clock() - time) * 1000 / CLOCKS_PER_SEC));
+
+  (void)LDetachAll(&sorted);
+  (void)memset(unittest_timers, 0, sizeof(unittest_timers));
+
+  unittest_random = 2463534242u;
+  time = clock();
+
+  for(i = 0; i < UNITTEST_TIMERS; i++)
+    {
+      unittest_arm(&wheel, i, 1 + unittest_rand() % 100000);
+    }
+
+  printf("Timer wheel: %u timers armed in %u ms\n", UNITTEST_TIMERS,
+         (unsigned)((clock() - time) * 1000 / CLOCKS_PER_SEC));
+
+  time = clock();
+
+  for(now = 1; LTimerCount(&wheel) > 0; now++)
+    {
+      (void)LTimerAdvance(&wheel, now, &expired);
+      (void)LDetachAll(&expired);
+    }
+
+  printf("Timer wheel: %u ticks advanced in %u ms\n", now - 1,
+         (unsigned)((clock() - time) * 1000 / CLOCKS_PER_SEC));
+
+  printf("OK\n");
+}
+
+
+/*
+ *  Test harness for timer wheel.
+ *
+ */
+int main(void)
+{
+  printf("\nunittest - ltimer.c\n");
+
+  unittest_testset1();
+  unittest_testset2();
+  unittest_testset3();
+
+  printf("\nunittest - done.\n");
+  return 0;
+}
+
+#endif /* LTIMER_UNITTEST */
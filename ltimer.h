@@ -0,0 +1,171 @@
+/*
+ *  Linked List Timer Wheel Header
+ *
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#ifndef LTIMER_H
+#define LTIMER_H
+
+
+#include "llist.h"
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Hierarchical timer wheel of linked list nodes.
+ *
+ *  Wheel has LTIMER_LEVELS levels of LTIMER_SLOTS slots, and each slot
+ *  is llist_t of timers. Level 0 slots are single ticks, level 1 slots
+ *  are LTIMER_SLOTS ticks, and so on. Timer is attached into the slot
+ *  of the lowest level, which covers its expiry time, thus arming and
+ *  cancelling are O(1) (LAttachLast and LDetach) for any amount of timers.
+ *
+ *   level 0:  [t][t][t][t][t][t][t]....     one tick per slot
+ *   level 1:  [    t    ][    t    ]....    LTIMER_SLOTS ticks per slot
+ *   level 2:  ....
+ *
+ *  When level 0 wraps around, the timers of the next level 1 slot are
+ *  cascaded into level 0 slots (and level 2 into level 1 likewise), so
+ *  each timer is moved at most once per level before it expires.
+ *
+ *  Time is counted in ticks (unsigned, wrapping around is allowed), and
+ *  timer can be armed at most LTIMER_MAX_TICKS ticks ahead. Expired timers
+ *  of each advance are returned as one batch list in order of expiry.
+ *
+ *  Wheel does not allocate nodes: timers are intrusive objects, which
+ *  begin with LTIMER_NODE fields, and owned by the caller.
+ *
+ *  (This library is not thread safe, as llist.h is not either)
+ *
+ */
+
+/* --------------------------------------------------------------- */
+/* 1. Structure and prototypes for timer wheel usage               */
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Size of wheel (LTIMER_LEVELS * LTIMER_SLOT_BITS must be below 32).
+ */
+#ifndef LTIMER_LEVELS
+#define LTIMER_LEVELS      5
+#endif
+
+#ifndef LTIMER_SLOT_BITS
+#define LTIMER_SLOT_BITS   6
+#endif
+
+#define LTIMER_SLOTS       (1u << LTIMER_SLOT_BITS)
+#define LTIMER_MAX_TICKS   ((1u << (LTIMER_LEVELS * LTIMER_SLOT_BITS)) - 1)
+
+
+/*
+ *  (ltimer_t*) -  Timer node, LTIMER_NODE fields in the beginning of
+ *  the structure (as LLIST_NODE with lists).
+ */
+#define LTIMER_NODE       \
+  LLIST_NODE              \
+  unsigned  expires;      \
+  llist_t * slot;
+
+typedef struct
+{
+  LTIMER_NODE
+} ltimer_t;
+
+
+/*
+ *  (lwheel_t) -  Timer wheel, only accessed by LTimer* functions
+ *  (can be static object).
+ */
+typedef struct
+{
+  unsigned  now;             /* Last processed tick           */
+  unsigned  count;           /* Armed timers                  */
+  unsigned  levels[LTIMER_LEVELS];   /* Armed timers per level */
+  llist_t   slots[LTIMER_LEVELS][LTIMER_SLOTS];
+
+} lwheel_t;
+
+
+/* --------------------------------------------------------------- */
+/* 2. Functions for timer handling.                                */
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Setup the wheel object with current tick (no allocations).
+ */
+void       LTimerSetup( lwheel_t * wheel, unsigned now );
+
+
+/*
+ *  Arm timer to expire after given ticks (at least one, at most
+ *  LTIMER_MAX_TICKS), re-arming timer which is already armed.
+ *  Cancel returns LLIST_NO if timer was not armed.
+ */
+void       LTimerArm(    lwheel_t * wheel, ltimer_t * timer, unsigned ticks );
+lbool_e    LTimerCancel( lwheel_t * wheel, ltimer_t * timer );
+
+
+/*
+ *  Advance wheel to given tick, and attach the expired timers as last
+ *  into the list (in order of expiry). Returns the amount of expired timers.
+ *  Expired timers are not armed, but they must be detached from the list
+ *  before they are armed again.
+ */
+unsigned   LTimerAdvance( lwheel_t * wheel, unsigned now, llist_t * expired );
+
+
+/*
+ *  Get wheel and timer information.
+ */
+#define    LTimerNow( wheel )      ((unsigned)(wheel)->now)
+#define    LTimerCount( wheel )    ((unsigned)(wheel)->count)
+#define    LTimerArmed( timer )    ((lbool_e)((timer)->slot != NULL))
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Example how to use timer wheel.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *
+ *  typedef struct
+ *  {
+ *    LTIMER_NODE
+ *    int  socket;
+ *  } connection_t;
+ *
+ *  static lwheel_t timeouts;
+ *  llist_t         expired;
+ *
+ *  LTimerSetup(&timeouts, GetTicks());
+ *  LSetup(expired, 0, NULL);
+ *
+ *  LTimerArm(&timeouts, (ltimer_t*)conn, 30 * TICKS_PER_SECOND);
+ *
+ *  // periodically
+ *  LTimerAdvance(&timeouts, GetTicks(), &expired);
+ *
+ *  while((conn = (connection_t*)LDetachFirst(&expired)) != NULL)
+ *    {
+ *      CloseConnection(conn);
+ *    }
+ */
+
+
+/* --------------------------------------------------------------- */
+
+#endif /* LTIMER_H */
+
+#ifdef __cplusplus
+}
+#endif
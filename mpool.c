@@ -45,10 +45,9 @@
  */
 
 
-#ifdef MPOOL_UNITTEST
+#if defined MPOOL_UNITTEST || defined LLIST_UNITTEST || defined LLIST_OS_STUBS
 
 static void * os_block_alloc(unsigned size);
-static void * os_block_alloc_and_clear(unsigned size);
 static void * os_block_alloc_no_wait(unsigned size);
 static void   os_block_dealloc(void * ptr);
 
@@ -106,8 +105,10 @@ typedef struct
 #define SILO_ADDRESS( silo, block )  ((void*)(silo) < block && block < (silo)->addr_limit)
 #define SILO_SIZE( size )            (sizeof(msilo_t) + (size) * SILO_CAPACITY)
 #define SILO_LIMIT( silo, size )     (void*)((char*)(silo) + SILO_SIZE(size))
-#define MODE_MEMSET( pool )          ((mpool)->modes & MPOOL_TRUE)
-#define MODE_NOWAIT( pool )          ((mpool)->modes & (MPOOL_TRUE < 1))
+#define MODE_NOWAIT_BIT              1
+#define MODE_MEMSET_BIT              2
+#define MODE_NOWAIT( mpool )         ((mpool)->modes & MODE_NOWAIT_BIT)
+#define MODE_MEMSET( mpool )         ((mpool)->modes & MODE_MEMSET_BIT)
 
 
 /*
@@ -134,7 +135,7 @@ static msilo_t * create_new_silo( mpool_t * mpool, lbool_e no_wait )
  *
  *
  */
-static void cleanup_empty_silos( mpool_t * mpool, mpool_bool_e check_all)
+static void cleanup_empty_silos( mpool_t * mpool, lbool_e check_all)
 {
   msilo_t * silo = (msilo_t*)LFirst(&mpool->silos);
 
@@ -148,7 +149,7 @@ static void cleanup_empty_silos( mpool_t * mpool, mpool_bool_e check_all)
           LRemove(&mpool->silos, (lnode_t*)silo);
           mpool->capacity -= SILO_CAPACITY;
 
-          if (check_all == MPOOL_FALSE)
+          if (check_all == LLIST_NO)
             {
               break;
             }
@@ -218,11 +219,11 @@ static void * silo_block_alloc(mpool_t * mpool, msilo_t * silo)
 static void silo_block_dealloc(mpool_t * mpool, msilo_t * silo, void * block)
 {
   /* Calculate index (instead of search) */
-  unsigned index = (unsigned)((unsigned)block - 
-      ((unsigned)silo + sizeof(msilo_t))) / mpool->block_size;
+  unsigned index = (unsigned)(((char*)block - 
+      ((char*)silo + sizeof(msilo_t))) / mpool->block_size);
 
   /* Mark the "blocks[index]" as free */
-  silo->memchart &= ~(1 << index);
+  silo->memchart &= ~(1u << index);
 
   mpool->used--;
 }
@@ -235,7 +236,7 @@ static void silo_block_dealloc(mpool_t * mpool, msilo_t * silo, void * block)
  *
  *
  */
-void * MPoolInit( unsigned block_size, mpool_bool_e alloc_no_wait, mpool_bool_e memset_zero )
+void * MPoolInit( unsigned block_size, mpool_alloc_e allocation, mpool_memset_e memory )
 {
   mpool_t * mpool;
   unsigned init_size;
@@ -249,7 +250,7 @@ void * MPoolInit( unsigned block_size, mpool_bool_e alloc_no_wait, mpool_bool_e
   /* Allocation includes memory pool and linked list headers and one silo */
   init_size = sizeof(mpool_t) + SILO_SIZE(block_size);
 
-  if (alloc_no_wait)
+  if (allocation == MPOOL_NOWAIT)
     {
       mpool = os_block_alloc_no_wait(init_size);
     }
@@ -266,7 +267,8 @@ void * MPoolInit( unsigned block_size, mpool_bool_e alloc_no_wait, mpool_bool_e
       mpool->capacity   = SILO_CAPACITY;
       mpool->reserved   = SILO_CAPACITY;
       mpool->used       = 0;
-      mpool->modes      = alloc_no_wait | (memset_zero < 1);
+      mpool->modes      = (allocation == MPOOL_NOWAIT ? MODE_NOWAIT_BIT : 0) |
+                          (memory == MPOOL_ZERO_MEMSET ? MODE_MEMSET_BIT : 0);
 
       LSetup(mpool->silos, 0, NULL);
 
@@ -310,7 +312,7 @@ void * MPoolAlloc(void * pool)
 
       if (!block)
         {
-          silo = create_new_silo(mpool, MODE_NOWAIT(mpool));
+          silo = create_new_silo(mpool, (MODE_NOWAIT(mpool) ? LLIST_YES : LLIST_NO));
 
           if (silo)
             {
@@ -332,7 +334,7 @@ void * MPoolAlloc(void * pool)
  *
  *
  */
-void * MPoolAllocFlexible(void * pool, unsigned size, mpool_bool_e alloc_no_wait, mpool_bool_e memset_zero)
+void * MPoolAllocFlexible(void * pool, unsigned size, mpool_alloc_e allocation, mpool_memset_e memory)
 {
   void * block = NULL;
 
@@ -358,7 +360,7 @@ void * MPoolAllocFlexible(void * pool, unsigned size, mpool_bool_e alloc_no_wait
 
           if (!block)
             {
-              silo = create_new_silo(mpool, alloc_no_wait);
+              silo = create_new_silo(mpool, (allocation == MPOOL_NOWAIT ? LLIST_YES : LLIST_NO));
 
               if (silo)
                 {
@@ -368,7 +370,7 @@ void * MPoolAllocFlexible(void * pool, unsigned size, mpool_bool_e alloc_no_wait
         }
       else
         {
-          if (alloc_no_wait)
+          if (allocation == MPOOL_NOWAIT)
             {
               block = os_block_alloc_no_wait(size);
             }
@@ -378,9 +380,9 @@ void * MPoolAllocFlexible(void * pool, unsigned size, mpool_bool_e alloc_no_wait
             }
         }
 
-      if (MODE_MEMSET(mpool) && block)
+      if ((MODE_MEMSET(mpool) || memory == MPOOL_ZERO_MEMSET) && block)
         {
-          memset(block, 0, mpool->block_size);
+          memset(block, 0, (size > mpool->block_size ? size : mpool->block_size));
         }
     }
 
@@ -393,15 +395,18 @@ void * MPoolAllocFlexible(void * pool, unsigned size, mpool_bool_e alloc_no_wait
  *
  *
  */
-void MPoolDealloc(void * pool, void ** block)
+void MPoolDealloc(void * pool, void * block_ptr)
 {
+  void ** block = (void**)block_ptr;
+
   if (block)
     {
       mpool_t * mpool = (mpool_t*)pool;
-      msilo_t * silo  = (msilo_t*)LLast(&mpool->silos);
 
       if (pool)
         {
+          msilo_t * silo = (msilo_t*)LLast(&mpool->silos);
+
           do
             {
               if (SILO_ADDRESS(silo, *block))
@@ -412,7 +417,7 @@ void MPoolDealloc(void * pool, void ** block)
                       && mpool->reserved == SILO_CAPACITY
                       && mpool->capacity > mpool->used * 2)
                     {
-                      cleanup_empty_silos(mpool, MPOOL_FALSE);
+                      cleanup_empty_silos(mpool, LLIST_NO);
                     }
 
                   return;
@@ -433,7 +438,7 @@ void MPoolDealloc(void * pool, void ** block)
  *
  *
  */
-mpool_bool_e MPoolExtract(void * pool, void ** block)
+mpool_result_e MPoolExtract(void * pool, void ** block)
 {
   if (pool && block)
     {
@@ -451,8 +456,10 @@ mpool_bool_e MPoolExtract(void * pool, void ** block)
                   memcpy(ptr, *block, mpool->block_size);
                   silo_block_dealloc(mpool, silo, *block);
                   *block = ptr;
-                  return MPOOL_TRUE;
+                  return MPOOL_SUCCESS;
                 }
+
+              return MPOOL_FAILURE;
             }
 
           silo = (msilo_t*)LNext(silo);
@@ -460,7 +467,7 @@ mpool_bool_e MPoolExtract(void * pool, void ** block)
       while(silo);
     }
 
-  return MPOOL_FALSE;
+  return MPOOL_SUCCESS;
 }
 
 
@@ -484,7 +491,7 @@ unsigned MPoolReserveSpace(void * pool, unsigned amount, mpool_reservation_e mod
 
           if (mpool->reserved == SILO_CAPACITY)
             {
-              cleanup_empty_silos(mpool, MPOOL_TRUE);
+              cleanup_empty_silos(mpool, LLIST_YES);
             }
         }
       else /* MPOOL_RESERVE_FOR_ONE_USE or ... */
@@ -493,7 +500,7 @@ unsigned MPoolReserveSpace(void * pool, unsigned amount, mpool_reservation_e mod
 
           while(reserved < amount)
             {
-              if (!create_new_silo(mpool, LLIST_NO))
+              if (!create_new_silo(mpool, LLIST_YES))
                 {
                   break;
                 }
@@ -522,7 +529,7 @@ unsigned MPoolReserveSpace(void * pool, unsigned amount, mpool_reservation_e mod
 mpool_state_t MPoolGetStatistics(void * pool)
 {
   mpool_state_t statistics = {0, 0, 0, 0, 
-      MPOOL_RESERVE_RELEASE, MPOOL_FALSE, MPOOL_FALSE};
+      MPOOL_RESERVE_RELEASE, MPOOL_WAIT, MPOOL_NO_MEMSET};
 
   if (pool)
     {
@@ -547,12 +554,12 @@ mpool_state_t MPoolGetStatistics(void * pool)
 
       if (MODE_NOWAIT(mpool))
         {
-          statistics.alloc_no_wait = MPOOL_TRUE;
+          statistics.alloc = MPOOL_NOWAIT;
         }
 
       if (MODE_MEMSET(mpool))
         {
-          statistics.memset_zero = MPOOL_TRUE;
+          statistics.memset = MPOOL_ZERO_MEMSET;
         }
     }
 
@@ -585,7 +592,7 @@ void MPoolDispose(void ** pool)
 
 /* ----------------------------------------------------------------- */
 
-#ifdef MPOOL_UNITTEST
+#if defined MPOOL_UNITTEST || defined LLIST_UNITTEST || defined LLIST_OS_STUBS
 
 #include <math.h>
 #include <memory.h>
@@ -595,18 +602,13 @@ void MPoolDispose(void ** pool)
 #include <time.h>
 
 
-static unsigned os_block_alloc_occupied = 0;
+extern unsigned os_block_alloc_occupied;   /* in llist.c */
 
 static void * os_block_alloc(unsigned size)
 {
   return memcpy(malloc(size), "deadbeef", 8);
 }
 
-static void * os_block_alloc_and_clear(unsigned size)
-{
-  return memset(malloc(size), 0, size);
-}
-
 static void * os_block_alloc_no_wait(unsigned size)
 {
   return (os_block_alloc_occupied ? NULL : os_block_alloc(size));
@@ -617,6 +619,10 @@ static void os_block_dealloc(void* ptr)
   free(ptr);
 }
 
+#endif /* MPOOL_UNITTEST || LLIST_UNITTEST || LLIST_OS_STUBS */
+
+#ifdef MPOOL_UNITTEST
+
 static void dump_statistics(void * pool)
 {
   mpool_state_t statistics = MPoolGetStatistics(pool);
@@ -626,8 +632,8 @@ static void dump_statistics(void * pool)
   printf("blocks_used %d",statistics.blocks_used);
   printf("blocks_free %d",statistics.blocks_free);
   printf("reservation %d",statistics.reservation);
-  if (statistics.alloc_no_wait) printf("- os_block_alloc_no_wait in use\n");  
-  if (statistics.memset_zero)   printf("- memset zero in use\n");
+  if (statistics.alloc == MPOOL_NOWAIT)       printf("- os_block_alloc_no_wait in use\n");  
+  if (statistics.memset == MPOOL_ZERO_MEMSET) printf("- memset zero in use\n");
 }
 
 #define OUTER_LOOP 1500
@@ -641,7 +647,6 @@ static void dump_statistics(void * pool)
 int main(void)
 {
 
-  mpool_state_t statistics;
   void * pool;
   void * block;
   void * table[INNER_LOOP*5];
@@ -679,7 +684,7 @@ int main(void)
       
       for(j=0;j<OUTER_LOOP;j++)
         {
-          pool = MPoolInit(10, MPOOL_FALSE, MPOOL_FALSE);
+          pool = MPoolInit(10, MPOOL_WAIT, MPOOL_NO_MEMSET);
 
           for(i=0;i<k*INNER_LOOP;i++)
             {
@@ -702,11 +707,12 @@ int main(void)
     }
 
 
-  pool = MPoolInit(10, MPOOL_FALSE, MPOOL_FALSE);
+  pool = MPoolInit(10, MPOOL_WAIT, MPOOL_NO_MEMSET);
   block = MPoolAlloc(pool);
   MPoolExtract(pool, &block);
 
-  statistics = MPoolGetStatistics(pool);
+  dump_statistics(pool);
+  MPoolDispose(&pool);
 
   printf("\nUnittest - Done.\n");
 
@@ -30,7 +30,7 @@ extern "C"
  *  by using private memory pools.
  *
  *  Default setup of memory pool:
- *    void * pool = MPoolInit(sizeof(your_struct_t), MPOOL_FALSE, MPOOL_TRUE);
+ *    void * pool = MPoolInit(sizeof(your_struct_t), MPOOL_WAIT, MPOOL_ZERO_MEMSET);
  *
  *  This memory pool works as stand-alone library, but since this was designed
  *  specially for LList linked list (llist.h), this works perfectly with it.
@@ -102,7 +102,7 @@ typedef struct
  *                                 in case of OS out of memory.
  *        MPOOL_NOWAIT           : Uses os_block_alloc_no_wait, which
  *                                 waits until OS returns a memory po�nter.
- *    mpool_bool_e memset_zero
+ *    mpool_memset_e memory
  *        MPOOL_NO_MEMSET        : Returns memory area uncleared (faster).
  *        MPOOL_ZERO_MEMSET      : Clears the memory are with zeroes
  *
@@ -0,0 +1,955 @@
+/*
+ *  Unrolled Linked List
+ *
+ */
+
+/*
+ *  Unrolled Linked List Implementation.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *  Items are kept in chunks, which are nodes of ordinary llist_t, thus
+ *  the chunk handling (allocation from memory pool, linking) is done by
+ *  LList and this library handles only the items inside of the chunks.
+ *
+ *  Items are always packed to the beginning of the chunk. Creating item
+ *  as first or last uses the space of first or last chunk if available,
+ *  otherwise new chunk is created. Filtering removals compact the items
+ *  into full chunks and release the chunks left empty.
+ *
+ */
+
+/* ------------------------------------------------------------------------- */
+
+
+#ifdef ULIST_UNITTEST
+
+static void * os_block_alloc(unsigned size);
+static void * os_block_alloc_and_clear(unsigned size);
+static void   os_block_dealloc(void * ptr);
+
+#else /* ULIST_UNITTEST */
+
+/* Embedded OS headers */
+#include "global.h"
+#include "type_def.h"
+#include "os.h"
+
+#endif /* ULIST_UNITTEST */
+
+/* External libraries */
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include "mpool.h"
+#include "llist.h"
+
+/* Library header */
+#include "ulist.h"
+
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Chunk of items (node of chunks list).
+ *
+ */
+typedef struct
+{
+  LLIST_NODE
+  unsigned count;
+  unsigned padding;
+  /* items[chunk_items] */
+} uchunk_t;
+
+
+#define _UChunk( node )             ((uchunk_t*)(node))
+#define _UItem( list, chunk, i )    ((void*)((char*)(chunk) + sizeof(uchunk_t) + (i) * (list)->item_size))
+
+
+/*
+ *  Size of chunk with given item size and amount of items.
+ *
+ */
+unsigned UChunkSize( unsigned item_size, unsigned chunk_items )
+{
+  return sizeof(uchunk_t) + item_size * chunk_items;
+}
+
+
+/*
+ *  Allocates new unrolled list object.
+ *
+ */
+ulist_t * UInit( unsigned item_size, unsigned chunk_items, void * memorypool )
+{
+  ulist_t * list = (ulist_t*)os_block_alloc_and_clear(sizeof(ulist_t));
+
+  assert(item_size > 0);
+
+  if (chunk_items == 0)
+    {
+      chunk_items = (ULIST_CHUNK_BYTES - sizeof(uchunk_t)) / item_size;
+
+      if (chunk_items == 0)
+        {
+          chunk_items = 1;
+        }
+    }
+
+  list->item_size   = item_size;
+  list->chunk_items = chunk_items;
+
+  if (!memorypool)
+    {
+      memorypool = MPoolInit(UChunkSize(item_size, chunk_items), MPOOL_WAIT, MPOOL_ZERO_MEMSET);
+      list->own_pool = LLIST_YES;
+    }
+
+  /* Sanity check for chunk to fit into pool block */
+  assert(MPoolGetStatistics(memorypool).block_size >= UChunkSize(item_size, chunk_items));
+
+  list->memorypool = memorypool;
+
+  LSetup(list->chunks, UChunkSize(item_size, chunk_items), NULL);
+  list->chunks.memorypool = memorypool;
+
+  return list;
+}
+
+
+/*
+ *  Allocate empty chunk from pool (pool given by caller may not clear
+ *  blocks, and may return NULL if it does not wait for memory).
+ *
+ */
+static lnode_t * UNewChunk( ulist_t * list )
+{
+  lnode_t * chunk = (lnode_t*)MPoolAlloc(list->memorypool);
+
+  if (chunk)
+    {
+      chunk->next = NULL;
+      chunk->prev = NULL;
+      _UChunk(chunk)->count = 0;
+    }
+
+  return chunk;
+}
+
+
+/*
+ *  Release the chunk from list.
+ *
+ */
+static void URemoveChunk( ulist_t * list, lnode_t * chunk )
+{
+  LDetach(&list->chunks, chunk);
+  LDealloc(chunk, NULL, list->memorypool);
+}
+
+
+/*
+ *  Removes all items, but the list object itself remains valid.
+ *
+ */
+void URemoveAll( ulist_t * list )
+{
+  LRemoveAll(&list->chunks);
+  list->count = 0;
+}
+
+
+/*
+ *  Disposes the unrolled list by deallocating chunks and
+ *  finally the list object itself (and its own memory pool).
+ */
+void UDispose( ulist_t ** list )
+{
+  if (*list)
+    {
+      URemoveAll(*list);
+
+      if ((*list)->own_pool)
+        {
+          MPoolDispose(&(*list)->memorypool);
+        }
+
+      os_block_dealloc(*list);
+      *list = NULL;
+    }
+}
+
+
+/*
+ *  Get the first item.
+ *
+ */
+void * UFirst( ulist_t * list )
+{
+  lnode_t * chunk = LFirst(&list->chunks);
+
+  return (chunk ? _UItem(list, chunk, 0) : NULL);
+}
+
+
+/*
+ *  Get the last item.
+ *
+ */
+void * ULast( ulist_t * list )
+{
+  lnode_t * chunk = LLast(&list->chunks);
+
+  return (chunk ? _UItem(list, chunk, _UChunk(chunk)->count - 1) : NULL);
+}
+
+
+/*
+ *  Get item with certain index.
+ *
+ */
+void * UGetItem( ulist_t * list, unsigned index )
+{
+  lnode_t * chunk;
+
+  if (index < list->count)
+    {
+      /*
+       *  Minimize loop by checking if index is closer to begin or end.
+       */
+      if (index < list->count / 2)
+        {
+          LFor(lnode_t*, chunk, &list->chunks)
+            {
+              if (index < _UChunk(chunk)->count)
+                {
+                  return _UItem(list, chunk, index);
+                }
+
+              index -= _UChunk(chunk)->count;
+            }
+        }
+      else
+        {
+          index = list->count - index;
+
+          LBack(lnode_t*, chunk, &list->chunks)
+            {
+              if (index <= _UChunk(chunk)->count)
+                {
+                  return _UItem(list, chunk, _UChunk(chunk)->count - index);
+                }
+
+              index -= _UChunk(chunk)->count;
+            }
+        }
+    }
+
+  return NULL;
+}
+
+
+/*
+ *  Creates new item at the beginning of the list.
+ *
+ */
+void * UCreateFirst( ulist_t * list )
+{
+  lnode_t * chunk = LFirst(&list->chunks);
+  void *    item;
+
+  if (!chunk || _UChunk(chunk)->count == list->chunk_items)
+    {
+      chunk = UNewChunk(list);
+
+      if (!chunk)
+        {
+          return NULL;
+        }
+
+      LAttachFirst(&list->chunks, chunk);
+    }
+  else
+    {
+      /*
+       *  Make room for the item at the beginning of chunk.
+       */
+      (void)memmove(_UItem(list, chunk, 1), _UItem(list, chunk, 0),
+                    _UChunk(chunk)->count * list->item_size);
+    }
+
+  item = _UItem(list, chunk, 0);
+  (void)memset(item, 0, list->item_size);
+
+  _UChunk(chunk)->count++;
+  list->count++;
+
+  return item;
+}
+
+
+/*
+ *  Creates new item at the end of the list.
+ *
+ */
+void * UCreateLast( ulist_t * list )
+{
+  lnode_t * chunk = LLast(&list->chunks);
+  void *    item;
+
+  if (!chunk || _UChunk(chunk)->count == list->chunk_items)
+    {
+      chunk = UNewChunk(list);
+
+      if (!chunk)
+        {
+          return NULL;
+        }
+
+      LAttachLast(&list->chunks, chunk);
+    }
+
+  item = _UItem(list, chunk, _UChunk(chunk)->count);
+  (void)memset(item, 0, list->item_size);
+
+  _UChunk(chunk)->count++;
+  list->count++;
+
+  return item;
+}
+
+
+/*
+ *  Detach (pop) the first item from the list.
+ *
+ */
+lbool_e UDetachFirst( ulist_t * list, void * item )
+{
+  lnode_t * chunk = LFirst(&list->chunks);
+
+  if (chunk)
+    {
+      if (item)
+        {
+          (void)memcpy(item, _UItem(list, chunk, 0), list->item_size);
+        }
+
+      if (--_UChunk(chunk)->count)
+        {
+          (void)memmove(_UItem(list, chunk, 0), _UItem(list, chunk, 1),
+                        _UChunk(chunk)->count * list->item_size);
+        }
+      else
+        {
+          URemoveChunk(list, chunk);
+        }
+
+      list->count--;
+      return LLIST_YES;
+    }
+
+  return LLIST_NO;
+}
+
+
+/*
+ *  Detach (pop) the last item from the list.
+ *
+ */
+lbool_e UDetachLast( ulist_t * list, void * item )
+{
+  lnode_t * chunk = LLast(&list->chunks);
+
+  if (chunk)
+    {
+      if (item)
+        {
+          (void)memcpy(item, _UItem(list, chunk, _UChunk(chunk)->count - 1), list->item_size);
+        }
+
+      if (--_UChunk(chunk)->count == 0)
+        {
+          URemoveChunk(list, chunk);
+        }
+
+      list->count--;
+      return LLIST_YES;
+    }
+
+  return LLIST_NO;
+}
+
+
+/*
+ *  Start looping items.
+ *
+ */
+void * UIterFirst( ulist_t * list, uiter_t * iter )
+{
+  iter->chunk = LFirst(&list->chunks);
+  iter->index = 0;
+
+  return (iter->chunk ? _UItem(list, iter->chunk, 0) : NULL);
+}
+
+
+/*
+ *  Get next item of loop.
+ *
+ */
+void * UIterNext( ulist_t * list, uiter_t * iter )
+{
+  if (++iter->index >= _UChunk(iter->chunk)->count)
+    {
+      iter->chunk = LNext(iter->chunk);
+      iter->index = 0;
+
+      if (!iter->chunk)
+        {
+          return NULL;
+        }
+    }
+
+  return _UItem(list, iter->chunk, iter->index);
+}
+
+
+/*
+ *  Count number of items match to filter.
+ *
+ */
+unsigned UFilterCount( ulist_t * list, ItemFilter_f ItemFilter, unsigned user_data )
+{
+  lnode_t * chunk;
+  unsigned  match = 0;
+
+  if (ItemFilter)
+    {
+      LFor(lnode_t*, chunk, &list->chunks)
+        {
+          char *   item  = (char*)_UItem(list, chunk, 0);
+          unsigned count = _UChunk(chunk)->count;
+
+          while(count--)
+            {
+              match += ItemFilter(item, user_data);
+              item  += list->item_size;
+            }
+        }
+    }
+  else
+    {
+      match = list->count;
+    }
+
+  return match;
+}
+
+
+/*
+ *  Operate items match to filter (or all if no filter).
+ *
+ */
+unsigned UFilterOperate( ulist_t * list, ItemFilter_f ItemFilter,  unsigned user_data_filter,
+                                         ItemFilter_f ItemOperate, unsigned user_data_operate )
+{
+  lnode_t * chunk;
+  unsigned  match = 0;
+
+  if (ItemOperate)
+    {
+      LFor(lnode_t*, chunk, &list->chunks)
+        {
+          char *   item  = (char*)_UItem(list, chunk, 0);
+          unsigned count = _UChunk(chunk)->count;
+
+          while(count--)
+            {
+              if (!ItemFilter || ItemFilter(item, user_data_filter))
+                {
+                  (void)ItemOperate(item, user_data_operate);
+                  match++;
+                }
+
+              item += list->item_size;
+            }
+        }
+    }
+
+  return match;
+}
+
+
+/*
+ *  Remove items match to filter (and copy them to other list if given)
+ *  by compacting kept items towards the beginning of the list.
+ *
+ *  Write position never passes the read position, since chunks are
+ *  filled up fully while writing, thus items can be moved in place.
+ */
+static unsigned UCompact( ulist_t * list, ItemFilter_f ItemFilter, unsigned user_data, ulist_t * other )
+{
+  lnode_t * wchunk = LFirst(&list->chunks);
+  lnode_t * rchunk;
+  unsigned  windex = 0;
+  unsigned  rindex;
+  unsigned  match  = 0;
+  void *    copy   = NULL;
+
+  if (!wchunk)
+    {
+      return 0;
+    }
+
+  LFor(lnode_t*, rchunk, &list->chunks)
+    {
+      for(rindex = 0; rindex < _UChunk(rchunk)->count; rindex++)
+        {
+          void * item = _UItem(list, rchunk, rindex);
+
+          /* item not copied to other list (out of memory) is kept */
+          if (ItemFilter(item, user_data) &&
+              (!other || (copy = UCreateLast(other)) != NULL))
+            {
+              if (other)
+                {
+                  (void)memcpy(copy, item, list->item_size);
+                }
+
+              match++;
+            }
+          else
+            {
+              if (windex == list->chunk_items)
+                {
+                  _UChunk(wchunk)->count = windex;
+                  wchunk = LNext(wchunk);
+                  windex = 0;
+                }
+
+              if (wchunk != rchunk || windex != rindex)
+                {
+                  (void)memcpy(_UItem(list, wchunk, windex), item, list->item_size);
+                }
+
+              windex++;
+            }
+        }
+    }
+
+  /*
+   *  Release the chunks left empty.
+   */
+  _UChunk(wchunk)->count = windex;
+
+  while(LLast(&list->chunks) != wchunk)
+    {
+      URemoveChunk(list, LLast(&list->chunks));
+    }
+
+  if (windex == 0)
+    {
+      URemoveChunk(list, wchunk);
+    }
+
+  list->count -= match;
+
+  return match;
+}
+
+
+/*
+ *  Remove items match to filter.
+ *
+ */
+unsigned UFilterRemove( ulist_t * list, ItemFilter_f ItemFilter, unsigned user_data )
+{
+  if (ItemFilter)
+    {
+      return UCompact(list, ItemFilter, user_data, NULL);
+    }
+
+  return 0;
+}
+
+
+/*
+ *  Moves the items to other list based on filter function given.
+ *
+ */
+unsigned UFilterMove( ulist_t * list, ulist_t ** other, ItemFilter_f ItemFilter, unsigned user_data )
+{
+  /*
+   *  Use exiting list object or create a new one.
+   */
+  if (!*other)
+    {
+      *other = UInit(list->item_size, list->chunk_items, NULL);
+    }
+
+  assert((*other)->item_size == list->item_size);
+
+  if (ItemFilter)
+    {
+      return UCompact(list, ItemFilter, user_data, *other);
+    }
+
+  return 0;
+}
+
+
+/*
+ *  Sorts the items according to given compare function.
+ *
+ *  Items are copied into one array, which is sorted with bottom-up
+ *  merge sort (stable, O(n log n)) and then copied back to chunks.
+ */
+void USort( ulist_t * list, ItemCmp_f ItemCmp )
+{
+  if (ItemCmp && list->count > 1)
+    {
+      unsigned size   = list->item_size;
+      unsigned count  = list->count;
+      char *   buffer = (char*)os_block_alloc(count * size * 2);
+      char *   from   = buffer;
+      char *   to     = buffer + count * size;
+      char *   item   = buffer;
+      lnode_t * chunk;
+      unsigned width;
+
+      LFor(lnode_t*, chunk, &list->chunks)
+        {
+          (void)memcpy(item, _UItem(list, chunk, 0), _UChunk(chunk)->count * size);
+          item += _UChunk(chunk)->count * size;
+        }
+
+      for(width = 1; width < count; width *= 2)
+        {
+          unsigned start;
+
+          for(start = 0; start < count; start += width * 2)
+            {
+              unsigned left  = start;
+              unsigned mid   = (start + width < count ? start + width : count);
+              unsigned right = mid;
+              unsigned end   = (start + width * 2 < count ? start + width * 2 : count);
+              char *   out   = to + start * size;
+
+              while(left < mid && right < end)
+                {
+                  /* equal items taken from left side for stability */
+                  if (ItemCmp(from + right * size, from + left * size) < LNODECMP_EQUAL)
+                    {
+                      (void)memcpy(out, from + right++ * size, size);
+                    }
+                  else
+                    {
+                      (void)memcpy(out, from + left++ * size, size);
+                    }
+
+                  out += size;
+                }
+
+              (void)memcpy(out, from + left * size, (mid - left) * size);
+              out += (mid - left) * size;
+              (void)memcpy(out, from + right * size, (end - right) * size);
+            }
+
+          item = from;
+          from = to;
+          to   = item;
+        }
+
+      item = from;
+
+      LFor(lnode_t*, chunk, &list->chunks)
+        {
+          (void)memcpy(_UItem(list, chunk, 0), item, _UChunk(chunk)->count * size);
+          item += _UChunk(chunk)->count * size;
+        }
+
+      os_block_dealloc(buffer);
+    }
+}
+
+
+/* --------------------------------------------------------------- */
+
+#ifdef ULIST_UNITTEST
+
+/*
+ *  gcc -DULIST_UNITTEST -DLLIST_OS_STUBS -o ulist.exe ulist.c llist.c mpool.c
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+extern unsigned os_block_alloc_occupied;   /* in llist.c */
+
+static void * os_block_alloc(unsigned size)
+{
+  return memcpy(malloc(size), "deadbeef", 8);
+}
+
+static void * os_block_alloc_and_clear(unsigned size)
+{
+  return memset(malloc(size), 0, size);
+}
+
+static void os_block_dealloc(void* ptr)
+{
+  free(ptr);
+}
+
+
+/*
+ *  Test structure
+ *
+ */
+typedef struct
+{
+  int id;
+  int value;
+} test_item_t;
+
+
+static void unittest_show(char * name, ulist_t * list)
+{
+  test_item_t * item;
+  uiter_t iter;
+  unsigned count = 0;
+
+  printf("%s List, with %d items:\n", name, UCount(list));
+
+  UFor(test_item_t*, item, iter, list)
+    {
+      printf("item id=%d, value=%d\n", item->id, item->value);
+      count++;
+    }
+
+  assert(UCount(list) == count);
+  printf("-------------\n");
+}
+
+static signed int unittest_compare(const void* item1, const void* item2)
+{
+  return (signed int)(((test_item_t*)item1)->value - ((test_item_t*)item2)->value);
+}
+
+static lbool_e unittest_filter(const void* item, unsigned user_data)
+{
+  return (((test_item_t*)item)->value > (int)user_data ? LLIST_YES : LLIST_NO);
+}
+
+static lbool_e unittest_operate(const void* item, unsigned user_data)
+{
+  ((test_item_t*)item)->value += user_data;
+  return LLIST_YES;
+}
+
+
+/* ------ Testset 1 - create/detach ------ */
+static void unittest_testset1( void )
+{
+  ulist_t * list = UInit(sizeof(test_item_t), 4, NULL);
+  test_item_t * item;
+  test_item_t   copy;
+  int i;
+
+  printf("\nTestset 1 - create/detach.\n\n");
+
+  assert(UFirst(list) == NULL);
+  assert(UDetachFirst(list, &copy) == LLIST_NO);
+
+  for(i = 0; i < 10; i++)
+    {
+      item = (test_item_t*)UCreateLast(list);
+      item->id = i;
+      item->value = i * 10;
+    }
+
+  item = (test_item_t*)UCreateFirst(list);
+  item->id = -1;
+
+  assert(UCount(list) == 11);
+  assert(((test_item_t*)UFirst(list))->id == -1);
+  assert(((test_item_t*)ULast(list))->id  == 9);
+  assert(((test_item_t*)UGetItem(list, 3))->id == 2);
+  assert(((test_item_t*)UGetItem(list, 9))->id == 8);
+  assert(UGetItem(list, 11) == NULL);
+  unittest_show("", list);
+
+  assert(UDetachFirst(list, &copy) == LLIST_YES);
+  assert(copy.id == -1);
+  assert(UDetachLast(list, &copy) == LLIST_YES);
+  assert(copy.id == 9);
+  assert(UCount(list) == 9);
+
+  while(UDetachLast(list, NULL));
+  assert(UCount(list) == 0);
+  assert(LCount(&list->chunks) == 0);
+
+  UDispose(&list);
+  assert(!list);
+}
+
+
+/* ------ Testset 2 - filtering ------ */
+static void unittest_testset2( void )
+{
+  ulist_t * list  = UInit(sizeof(test_item_t), 0, NULL);
+  ulist_t * other = NULL;
+  test_item_t * item;
+  int i;
+
+  printf("\nTestset 2 - filtering.\n\n");
+
+  for(i = 0; i < 100; i++)
+    {
+      item = (test_item_t*)UCreateLast(list);
+      item->id = i;
+      item->value = i;
+    }
+
+  assert(UFilterCount(list, unittest_filter, 49) == 50);
+  assert(UFilterOperate(list, unittest_filter, 89, unittest_operate, 1000) == 10);
+  assert(UFilterCount(list, unittest_filter, 999) == 10);
+
+  assert(UFilterMove(list, &other, unittest_filter, 999) == 10);
+  assert(UCount(list) == 90);
+  assert(UCount(other) == 10);
+  assert(((test_item_t*)UFirst(other))->id == 90);
+
+  assert(UFilterRemove(list, unittest_filter, 9) == 80);
+  assert(UCount(list) == 10);
+  assert(LCount(&list->chunks) == 1);
+  assert(((test_item_t*)ULast(list))->id == 9);
+
+  assert(UFilterRemove(list, unittest_filter, -1) == 10);
+  assert(UCount(list) == 0);
+  assert(LCount(&list->chunks) == 0);
+
+  UDispose(&list);
+  UDispose(&other);
+}
+
+
+/* ------ Testset 3 - sorting ------ */
+static void unittest_testset3( void )
+{
+  ulist_t * list = UInit(sizeof(test_item_t), 3, NULL);
+  test_item_t * item;
+  test_item_t * prev = NULL;
+  uiter_t iter;
+  int i;
+
+  printf("\nTestset 3 - sorting.\n\n");
+
+  for(i = 0; i < 50; i++)
+    {
+      item = (test_item_t*)UCreateFirst(list);
+      item->id = i;
+      item->value = (i * 7) % 10;
+    }
+
+  USort(list, unittest_compare);
+  unittest_show("sorted", list);
+
+  UFor(test_item_t*, item, iter, list)
+    {
+      if (prev)
+        {
+          assert(prev->value <= item->value);
+          /* stable: created as first, thus id descending with equal values */
+          assert(prev->value < item->value || prev->id > item->id);
+        }
+
+      prev = item;
+    }
+
+  UDispose(&list);
+}
+
+static void unittest_testset4( void )
+{
+  void *    pool = MPoolInit(UChunkSize(sizeof(test_item_t), 4), MPOOL_WAIT, MPOOL_NO_MEMSET);
+  ulist_t * list = UInit(sizeof(test_item_t), 4, pool);
+  test_item_t * item;
+  int i;
+
+  printf("\nTestset 4 - pool without memset.\n\n");
+
+  for(i = 0; i < 20; i++)
+    {
+      item = (test_item_t*)(i % 2 ? UCreateFirst(list) : UCreateLast(list));
+      assert(item && item->id == 0 && item->value == 0);
+      item->id = i;
+    }
+
+  assert(UCount(list) == 20);
+  assert(((test_item_t*)UGetItem(list, 0))->id == 19);
+  assert(((test_item_t*)UGetItem(list, 19))->id == 18);
+
+  UDispose(&list);
+  MPoolDispose(&pool);
+}
+
+
+/* ------ Testset 5 - move out of memory ------ */
+static void unittest_testset5( void )
+{
+  void *    pool  = MPoolInit(UChunkSize(sizeof(test_item_t), 1), MPOOL_NOWAIT, MPOOL_ZERO_MEMSET);
+  ulist_t * list  = UInit(sizeof(test_item_t), 4, NULL);
+  ulist_t * other = UInit(sizeof(test_item_t), 1, pool);
+  test_item_t * item;
+  int i;
+
+  printf("\nTestset 5 - move out of memory.\n\n");
+
+  for(i = 0; i < 40; i++)
+    {
+      item = (test_item_t*)UCreateLast(list);
+      item->id = i;
+      item->value = i;
+    }
+
+  /* other list gets only the chunks of pool's first silo */
+  os_block_alloc_occupied = LLIST_YES;
+  assert(UFilterMove(list, &other, unittest_filter, 4) == MPOOL_BLOCKS_IN_GROUP);
+  os_block_alloc_occupied = LLIST_NO;
+
+  assert(UCount(other) == MPOOL_BLOCKS_IN_GROUP);
+  assert(((test_item_t*)ULast(other))->id == 4 + MPOOL_BLOCKS_IN_GROUP);
+  assert(UCount(list) == 40 - MPOOL_BLOCKS_IN_GROUP);
+  assert(((test_item_t*)UGetItem(list, 4))->id == 4);
+  assert(((test_item_t*)UGetItem(list, 5))->id == 5 + MPOOL_BLOCKS_IN_GROUP);
+  assert(((test_item_t*)ULast(list))->id == 39);
+
+  assert(UFilterMove(list, &other, unittest_filter, 4) == 40 - MPOOL_BLOCKS_IN_GROUP - 5);
+  assert(UCount(list) == 5 && UCount(other) == 35);
+
+  UDispose(&list);
+  UDispose(&other);
+  MPoolDispose(&pool);
+}
+
+
+/*
+ *  Test harness for unrolled list.
+ *
+ */
+int main(void)
+{
+  printf("\nunittest - ulist.c\n");
+
+  unittest_testset1();
+  unittest_testset2();
+  unittest_testset3();
+  unittest_testset4();
+  unittest_testset5();
+
+  printf("\nunittest - done.\n");
+  return 0;
+}
+
+#endif /* ULIST_UNITTEST */
@@ -0,0 +1,200 @@
+/*
+ *  Unrolled Linked List Header
+ *
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#ifndef ULIST_H
+#define ULIST_H
+
+
+#include "llist.h"
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Unrolled (chunked) linked list library.
+ *
+ *  Alternative for llist_t when items are small and of fixed size.
+ *  Each chunk holds several items in an array, thus the next/prev
+ *  overhead is shared by all items of the chunk and traversals
+ *  touch far fewer cache lines than with one item per node.
+ *
+ *   chunk:  [next/prev|count| item | item | item | .... ]
+ *              |
+ *   chunk:  [next/prev|count| item | item | ....         ]
+ *
+ *  Chunks are linked with llist_t and allocated from memory pool
+ *  (mpool.h). Items are copied by value and may be moved in memory
+ *  by any insertion or removal, so pointers to items are valid only
+ *  until the list is modified next time.
+ *
+ *  (This library is not thread safe, as llist.h is not either)
+ *
+ */
+
+/* --------------------------------------------------------------- */
+/* 1. Structure and prototypes for list usage                      */
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Default size of one chunk in bytes, if no item count given.
+ */
+#define ULIST_CHUNK_BYTES  256
+
+
+/*
+ *  Callback prototypes. Item parameters guaranteed to be not NULLs when called.
+ */
+typedef lbool_e    (*ItemFilter_f)( const void * item,  unsigned user_data );
+typedef signed int (*ItemCmp_f)   ( const void * item1, const void * item2 );
+
+
+/*
+ *  (ulist_t*) -  Unrolled list type holding chunks of items.
+ */
+typedef struct
+{
+  llist_t   chunks;
+  unsigned  item_size;
+  unsigned  chunk_items;
+  unsigned  count;
+
+  /*
+   *  Memory pool of chunks, which is created by UInit
+   *  if not given (and then disposed by UDispose).
+   */
+  void *    memorypool;
+  lbool_e   own_pool;
+
+} ulist_t;
+
+
+/*
+ *  Iterator for looping through items.
+ */
+typedef struct
+{
+  lnode_t * chunk;
+  unsigned  index;
+} uiter_t;
+
+
+/* --------------------------------------------------------------- */
+/* 2. Functions for unrolled list handling.                        */
+/* --------------------------------------------------------------- */
+
+
+/*
+ *  Initialize (and allocates) the unrolled list object with given item size
+ *  and amount of items in chunk (0 for default ULIST_CHUNK_BYTES chunks).
+ *  Memory pool can be given (block size must fit UChunkSize), or NULL
+ *  to create list own memory pool for chunks.
+ */
+ulist_t *  UInit( unsigned item_size, unsigned chunk_items, void * memorypool );
+unsigned   UChunkSize( unsigned item_size, unsigned chunk_items );
+
+
+/*
+ *  Remove all items, or dispose (dynamic) list and set it NULL.
+ */
+void       URemoveAll( ulist_t *  list );
+void       UDispose(   ulist_t ** list );
+
+
+/*
+ *  Get list information and items (NULL returned if no item).
+ *  Get by index loops through chunks, not items.
+ */
+#define    UCount( list )    ((unsigned)(list)->count)
+
+void *     UFirst(   ulist_t * list );
+void *     ULast(    ulist_t * list );
+void *     UGetItem( ulist_t * list, unsigned index );
+
+
+/*
+ *  Create new item (cleared with zeroes) as first or last.
+ *  NULL returned if chunk could not be allocated from the pool.
+ */
+void *     UCreateFirst( ulist_t * list );
+void *     UCreateLast(  ulist_t * list );
+
+
+/*
+ *  Detach (pop) the first or last item by copying it to given
+ *  buffer (if not NULL). LLIST_NO returned if list was empty.
+ */
+lbool_e    UDetachFirst( ulist_t * list, void * item );
+lbool_e    UDetachLast(  ulist_t * list, void * item );
+
+
+/*
+ *  Forward loop for unrolled lists.
+ */
+void *     UIterFirst( ulist_t * list, uiter_t * iter );
+void *     UIterNext(  ulist_t * list, uiter_t * iter );
+
+#define    UFor( type, item, iter, list ) \
+    for( item = (type)UIterFirst(list, &(iter)); item != NULL; item = (type)UIterNext(list, &(iter)) )
+
+
+/*
+ *  Traverse through items and count/remove/operate items which match by filter.
+ *  Removal compacts the remaining items into as few chunks as possible.
+ */
+unsigned   UFilterCount(   ulist_t * list, ItemFilter_f ItemFilter,  unsigned user_data );
+unsigned   UFilterRemove(  ulist_t * list, ItemFilter_f ItemFilter,  unsigned user_data );
+unsigned   UFilterOperate( ulist_t * list, ItemFilter_f ItemFilter,  unsigned user_data_filter,
+                                           ItemFilter_f ItemOperate, unsigned user_data_operate );
+
+/*
+ *  Move items from one list to other list (allocated if NULL given) by filter.
+ *  Returns the count of items moved: with no wait pool of other list, items
+ *  for which chunk could not be allocated are left in the list.
+ */
+unsigned   UFilterMove(    ulist_t * list, ulist_t ** other, ItemFilter_f ItemFilter, unsigned user_data );
+
+
+/*
+ *  Sort items with given compare function (stable merge sort).
+ */
+void       USort( ulist_t * list, ItemCmp_f ItemCmp );
+
+
+/* --------------------------------------------------------------- */
+
+/*
+ *  Example how to use unrolled list.
+ *  ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+ *
+ *  ulist_t * events = UInit(sizeof(event_t), 0, NULL);
+ *  event_t * event;
+ *  uiter_t   iter;
+ *
+ *  event = (event_t*)UCreateLast(events);
+ *  event->id = 1;
+ *
+ *  UFor( event_t*, event, iter, events )
+ *    {
+ *      printf("event id: %d", event->id);
+ *    }
+ *
+ *  UDispose(&events);
+ */
+
+
+/* --------------------------------------------------------------- */
+
+#endif /* ULIST_H */
+
+#ifdef __cplusplus
+}
+#endif